@@ -101,6 +101,14 @@ static void printDisassembledOutputWithCalls(QByteArray processedOutput,
 JIT::PlatformAssemblerCommon::~PlatformAssemblerCommon()
 {}
 
+/*
+    The generated code is bound to the current process: Runtime functions and helpers
+    are called through their absolute addresses, and the exception handler and unwind
+    labels are patched in as absolute code addresses below. Caching it across processes
+    (e.g. next to the .qmlc files) would therefore require recording and applying
+    relocations for all of those, on top of validating the CPU features and the Qt
+    build. Until then, the code is regenerated in each process.
+*/
 void PlatformAssemblerCommon::link(Function *function, const char *jitKind)
 {
     for (const auto &jumpTarget : jumpsToLink)
@@ -320,6 +320,49 @@ public:
         return done;
     }
 
+    // converts src into dest if it holds a number, jumps to notNumber otherwise
+    void numberToDouble(RegisterID src, FPRegisterID dest, JumpList &notNumber)
+    {
+        urshift64(src, TrustedImm32(Value::QuickType_Shift), ScratchRegister2);
+        Jump notInt = branch32(NotEqual, TrustedImm32(Value::QT_Int), ScratchRegister2);
+        convertInt32ToDouble(src, dest);
+        Jump done = jump();
+
+        notInt.link(this);
+        move(TrustedImm64(Value::DoubleMask), ScratchRegister2);
+        and64(src, ScratchRegister2);
+        notNumber.append(branch64(LessThan, ScratchRegister2,
+                                  TrustedImm64(Value::DoubleDiscriminator)));
+        move(TrustedImm64(Value::EncodeMask), ScratchRegister2);
+        xor64(src, ScratchRegister2);
+        move64ToDouble(ScratchRegister2, dest);
+
+        done.link(this);
+    }
+
+    // fastPath has to calculate the result from lhs (in FPScratchRegister) and the
+    // accumulator (in FPScratchRegister2) into FPScratchRegister
+    Jump binopBothNumberPath(Address lhsAddr, std::function<void(void)> fastPath)
+    {
+        JumpList notNumber;
+        load64(lhsAddr, ScratchRegister);
+        numberToDouble(ScratchRegister, FPScratchRegister, notNumber);
+        numberToDouble(AccumulatorRegister, FPScratchRegister2, notNumber);
+
+        fastPath();
+
+        // NaNs need to be encoded in a canonical form, leave that to the slow path
+        notNumber.append(branchDouble(DoubleNotEqualOrUnordered,
+                                      FPScratchRegister, FPScratchRegister));
+        encodeDoubleIntoAccumulator(FPScratchRegister);
+        Jump done = jump();
+
+        // all other cases
+        notNumber.link(this);
+
+        return done;
+    }
+
     Jump unopIntPath(std::function<Jump(void)> fastPath)
     {
         urshift64(AccumulatorRegister, TrustedImm32(Value::IsIntegerConvertible_Shift), ScratchRegister);
@@ -752,6 +795,14 @@ public:
         return done;
     }
 
+    Jump binopBothNumberPath(Address lhsAddr, std::function<void(void)> fastPath)
+    {
+        // not implemented, doubles are handled by the runtime
+        Q_UNUSED(lhsAddr);
+        Q_UNUSED(fastPath);
+        return Jump();
+    }
+
     Jump unopIntPath(std::function<Jump(void)> fastPath)
     {
         Jump accNotInt = branch32(NotEqual, TrustedImm32(int(IntegerTag)), AccumulatorRegisterTag);
@@ -831,6 +882,27 @@ void BaselineAssembler::addLabel(int offset)
     pasm()->addLabelForOffset(offset);
 }
 
+void BaselineAssembler::jumpToOnStackReplacementTarget(const quint32_le *loopStarts,
+                                                       uint nLoopStarts)
+{
+    if (nLoopStarts == 0)
+        return;
+
+    const Address target(PlatformAssembler::CppStackFrameRegister,
+                         offsetof(JSTypesStackFrame, onStackReplacementOffset));
+    auto regularCall = pasm()->branch32(PlatformAssembler::LessThan, target, TrustedImm32(0));
+    pasm()->load32(target, PlatformAssembler::ScratchRegister);
+    pasm()->store32(TrustedImm32(-1), target);
+    for (uint i = 0; i < nLoopStarts; ++i) {
+        const int offset = int(loopStarts[i]);
+        pasm()->addJumpToOffset(pasm()->branch32(PlatformAssembler::Equal,
+                                                 PlatformAssembler::ScratchRegister,
+                                                 TrustedImm32(offset)),
+                                offset);
+    }
+    regularCall.link(pasm());
+}
+
 void BaselineAssembler::loadConst(int constIndex)
 {
     //###
@@ -1029,6 +1101,11 @@ void BaselineAssembler::add(int lhs)
         return overflowed;
     });
 
+    auto doneDouble = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+        pasm()->addDouble(PlatformAssembler::FPScratchRegister2,
+                          PlatformAssembler::FPScratchRegister);
+    });
+
     // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(3);
@@ -1040,6 +1117,8 @@ void BaselineAssembler::add(int lhs)
 
     // done.
     done.link(pasm());
+    if (doneDouble.isSet())
+        doneDouble.link(pasm());
 }
 
 void BaselineAssembler::bitAnd(int lhs)
@@ -1182,6 +1261,11 @@ void BaselineAssembler::mul(int lhs)
         return overflowed;
     });
 
+    auto doneDouble = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+        pasm()->mulDouble(PlatformAssembler::FPScratchRegister2,
+                          PlatformAssembler::FPScratchRegister);
+    });
+
     // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(2);
@@ -1192,6 +1276,8 @@ void BaselineAssembler::mul(int lhs)
 
     // done.
     done.link(pasm());
+    if (doneDouble.isSet())
+        doneDouble.link(pasm());
 }
 
 void BaselineAssembler::div(int lhs)
@@ -1225,6 +1311,11 @@ void BaselineAssembler::sub(int lhs)
         return overflowed;
     });
 
+    auto doneDouble = pasm()->binopBothNumberPath(regAddr(lhs), [this](){
+        pasm()->subDouble(PlatformAssembler::FPScratchRegister2,
+                          PlatformAssembler::FPScratchRegister);
+    });
+
     // slow path:
     saveAccumulatorInFrame();
     pasm()->prepareCallWithArgCount(2);
@@ -1235,6 +1326,8 @@ void BaselineAssembler::sub(int lhs)
 
     // done.
     done.link(pasm());
+    if (doneDouble.isSet())
+        doneDouble.link(pasm());
 }
 
 void BaselineAssembler::cmpeqNull()
@@ -42,6 +42,7 @@ public:
     void generateEpilogue();
     void link(Function *function);
     void addLabel(int offset);
+    void jumpToOnStackReplacementTarget(const quint32_le *loopStarts, uint nLoopStarts);
 
     // loads/stores/moves
     void loadConst(int constIndex);
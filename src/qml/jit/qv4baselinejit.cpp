@@ -33,6 +33,9 @@ void BaselineJIT::generate()
     as->generatePrologue();
     // Make sure the ACC register is initialized and not clobbered by the caller.
     as->loadAccumulatorFromFrame();
+    // The interpreter can switch to the jitted code at the start of a loop.
+    as->jumpToOnStackReplacementTarget(function->compiledFunction->labelInfoTable(),
+                                       function->compiledFunction->nLabelInfos);
     decode(code, len);
     as->generateEpilogue();
 
@@ -90,6 +90,7 @@ ReturnedValue ArrayBufferCtor::method_isView(const FunctionObject *, const Value
 void Heap::SharedArrayBuffer::init(size_t length)
 {
     Object::init();
+    externalDataRelease = nullptr;
     QPair<QTypedArrayData<char> *, char *> pair;
     if (length < UINT_MAX)
         pair =  QTypedArrayData<char>::allocate(length + 1);
@@ -109,16 +110,53 @@ void Heap::SharedArrayBuffer::init(size_t length)
 void Heap::SharedArrayBuffer::init(const QByteArray& array)
 {
     Object::init();
+    externalDataRelease = nullptr;
     new (&arrayDataPointerStorage) QArrayDataPointer<char>(*const_cast<QByteArray &>(array).data_ptr());
     isShared = true;
 }
 
+// Wraps \a length bytes at \a data, which belong to someone else, e.g. a
+// memory mapped file, without copying them. \a release is called once the
+// data isn't needed anymore. We take ownership of \a release.
+void Heap::SharedArrayBuffer::init(const char *data, size_t length, ExternalDataRelease *release)
+{
+    Object::init();
+    if (length >= UINT_MAX) {
+        new (&arrayDataPointerStorage) QArrayDataPointer<char>();
+        externalDataRelease = release;
+        releaseExternalData();
+        internalClass->engine->throwRangeError(QStringLiteral("ArrayBuffer: too large"));
+        return;
+    }
+    new (&arrayDataPointerStorage) QArrayDataPointer<char>(
+            QArrayDataPointer<char>::fromRawData(data, qsizetype(length)));
+    externalDataRelease = release;
+    isShared = true;
+}
+
 void Heap::SharedArrayBuffer::destroy()
 {
     arrayDataPointer().~QArrayDataPointer();
+    releaseExternalData();
     Object::destroy();
 }
 
+void Heap::SharedArrayBuffer::copyUnownedArrayData()
+{
+    QByteArray copy(constArrayData(), arrayDataLength());
+    arrayDataPointer() = std::move(copy.data_ptr());
+    releaseExternalData();
+}
+
+void Heap::SharedArrayBuffer::releaseExternalData()
+{
+    if (!externalDataRelease)
+        return;
+    (*externalDataRelease)();
+    delete externalDataRelease;
+    externalDataRelease = nullptr;
+}
+
 QByteArray ArrayBuffer::asByteArray() const
 {
     return QByteArray(constArrayData(), arrayDataLength());
@@ -18,6 +18,8 @@
 #include "qv4functionobject_p.h"
 #include <QtCore/qarraydatapointer.h>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -33,14 +35,29 @@ struct ArrayBufferCtor : SharedArrayBufferCtor {
 };
 
 struct Q_QML_EXPORT SharedArrayBuffer : Object {
+    // Releases external data. It is called from destroy(), which may run in
+    // any step of an incremental sweep, so it must not touch the engine.
+    using ExternalDataRelease = std::function<void()>;
+
     void init(size_t length);
     void init(const QByteArray& array);
+    void init(const char *data, size_t length, ExternalDataRelease *release);
     void destroy();
 
     void setSharedArrayBuffer(bool shared) noexcept { isShared = shared; }
     bool isSharedArrayBuffer() const noexcept { return isShared; }
 
-    char *arrayData() noexcept { return arrayDataPointer()->data(); }
+    char *arrayData()
+    {
+        // Data we don't own (raw data of a QByteArray, or external data) is
+        // read-only. Copy it before anyone can write to it. This releases
+        // external data, so any pointer obtained from constArrayData() before
+        // is invalid afterwards. Get the writable data first, or fetch the
+        // read-only data again after anything that might write to the buffer.
+        if (Q_UNLIKELY(!arrayDataPointer().d_ptr() && !hasDetachedArrayData()))
+            copyUnownedArrayData();
+        return arrayDataPointer()->data();
+    }
     const char *constArrayData() const noexcept { return constArrayDataPointer()->data(); }
     uint arrayDataLength() const noexcept { return constArrayDataPointer().size; }
 
@@ -51,6 +68,9 @@ struct Q_QML_EXPORT SharedArrayBuffer : Object {
     bool arrayDataNeedsDetach() const noexcept { return constArrayDataPointer().needsDetach(); }
 
 private:
+    void copyUnownedArrayData();
+    void releaseExternalData();
+
     const QArrayDataPointer<const char> &constArrayDataPointer() const noexcept
     {
         return *reinterpret_cast<const QArrayDataPointer<const char> *>(&arrayDataPointerStorage);
@@ -65,6 +85,7 @@ private:
 
     storage_t<QArrayDataPointer<char>>
     arrayDataPointerStorage;
+    ExternalDataRelease *externalDataRelease;
     bool isShared;
 };
 
@@ -77,6 +98,10 @@ struct Q_QML_EXPORT ArrayBuffer : SharedArrayBuffer {
         SharedArrayBuffer::init(array);
         setSharedArrayBuffer(false);
     }
+    void init(const char *data, size_t length, ExternalDataRelease *release) {
+        SharedArrayBuffer::init(data, length, release);
+        setSharedArrayBuffer(false);
+    }
 };
 
 }
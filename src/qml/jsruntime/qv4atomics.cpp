@@ -167,7 +167,7 @@ ReturnedValue Atomics::method_load(const FunctionObject *f, const Value *, const
     int bytesPerElement = a.d()->type->bytesPerElement;
     int byteOffset = a.d()->byteOffset + index * bytesPerElement;
 
-    return a.d()->type->atomicLoad(buffer->arrayData() + byteOffset);
+    return a.d()->type->atomicLoad(buffer->constArrayData() + byteOffset);
 }
 
 ReturnedValue Atomics::method_or(const FunctionObject *f, const Value *, const Value *argv, int argc)
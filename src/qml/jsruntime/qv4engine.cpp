@@ -37,6 +37,7 @@
 #include <private/qv4identifiertable_p.h>
 #include <private/qv4iterator_p.h>
 #include <private/qv4jsonobject_p.h>
+#include <private/qv4lookup_p.h>
 #include <private/qv4mapiterator_p.h>
 #include <private/qv4mapobject_p.h>
 #include <private/qv4mathobject_p.h>
@@ -76,6 +77,7 @@
 
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qiterable.h>
 #include <QtCore/qloggingcategory.h>
@@ -405,6 +407,9 @@ ExecutionEngine::ExecutionEngine(QJSEngine *jsEngine)
 
     identifierTable = new IdentifierTable(this);
 
+    if (LookupStatistics::isEnabled())
+        lookupStatistics = new LookupStatistics;
+
     memset(classes, 0, sizeof(classes));
     classes[Class_Empty] = memoryManager->allocIC<InternalClass>();
     classes[Class_Empty]->init(this);
@@ -871,6 +876,11 @@ ExecutionEngine::~ExecutionEngine()
 
     delete bumperPointerAllocator;
     delete regExpCache;
+    delete megamorphicLookupCache;
+    if (lookupStatistics) {
+        lookupStatistics->dump();
+        delete lookupStatistics;
+    }
     delete regExpAllocator;
     delete executableAllocator;
     jsStack->deallocate();
@@ -944,6 +954,22 @@ Heap::String *ExecutionEngine::newString(const QString &s)
     return memoryManager->allocWithStringData<String>(s.size() * sizeof(QChar), s);
 }
 
+/*!
+    \internal
+    Makes \a string the one that can be appended to in place. Strings account for
+    the size of their text in the unmanaged heap. The appendable string additionally
+    accounts for the room left in its buffer, as that is what the buffer was allocated
+    for. Strings that stop being appendable have usually filled their buffer.
+*/
+void ExecutionEngine::setAppendableString(Heap::String *string)
+{
+    const auto freeSpace = [](const Heap::String *s) {
+        return s ? qptrdiff(s->text().freeSpaceAtEnd()) * qptrdiff(sizeof(QChar)) : 0;
+    };
+    memoryManager->changeUnmanagedHeapSizeUsage(freeSpace(string) - freeSpace(appendableString));
+    appendableString = string;
+}
+
 Heap::String *ExecutionEngine::newIdentifier(const QString &text)
 {
     Scope scope(this);
@@ -952,6 +978,11 @@ Heap::String *ExecutionEngine::newIdentifier(const QString &text)
     return s->d();
 }
 
+Heap::String *ExecutionEngine::newIdentifier(QLatin1StringView text)
+{
+    return identifierTable->insertString(text);
+}
+
 Heap::Object *ExecutionEngine::newStringObject(const String *string)
 {
     return memoryManager->allocate<StringObject>(string);
@@ -1027,6 +1058,46 @@ Heap::ArrayBuffer *ExecutionEngine::newArrayBuffer(size_t length)
     return memoryManager->allocate<ArrayBuffer>(length);
 }
 
+// Creates an ArrayBuffer for \a length bytes at \a data without copying them.
+// The data is treated as read-only and is copied when written to. \a release is
+// called once the ArrayBuffer doesn't need the data anymore. Returns nullptr,
+// after calling \a release, if the data is too large for an ArrayBuffer.
+Heap::ArrayBuffer *ExecutionEngine::newArrayBuffer(
+        const char *data, size_t length, std::function<void()> release)
+{
+    if (length >= UINT_MAX) {
+        release();
+        return nullptr;
+    }
+    return memoryManager->allocate<ArrayBuffer>(
+            data, length, new Heap::ArrayBuffer::ExternalDataRelease(std::move(release)));
+}
+
+// Creates an ArrayBuffer with the contents of \a fileName. The file is memory
+// mapped if possible, so that large files are neither read nor copied up front.
+// Returns nullptr if the file can't be read, or is too large for an ArrayBuffer.
+Heap::ArrayBuffer *ExecutionEngine::newArrayBufferFromFile(const QString &fileName)
+{
+    auto file = std::make_unique<QFile>(fileName);
+    if (!file->open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const qint64 size = file->size();
+    if (quint64(size) >= UINT_MAX)
+        return nullptr;
+
+    if (uchar *mapped = size > 0 ? file->map(0, size) : nullptr) {
+        QFile *mappedFile = file.release();
+        return newArrayBuffer(reinterpret_cast<const char *>(mapped), size_t(size),
+                              [mappedFile]() { delete mappedFile; });
+    }
+
+    const QByteArray contents = file->readAll();
+    if (file->error() != QFileDevice::NoError || size_t(contents.size()) >= UINT_MAX)
+        return nullptr;
+    return newArrayBuffer(contents);
+}
+
 Heap::DateObject *ExecutionEngine::newDateObject(double dateTime)
 {
     return memoryManager->allocate<DateObject>(dateTime);
@@ -1335,6 +1406,9 @@ void ExecutionEngine::markObjects(MarkStack *markStack)
 
     identifierTable->markObjects(markStack);
 
+    if (regExpCache)
+        regExpCache->markObjects(markStack);
+
     for (const auto &compilationUnit : std::as_const(m_compilationUnits))
         compilationUnit->markObjects(markStack);
 }
@@ -29,6 +29,8 @@
 #include <QtCore/qprocessordetection.h>
 #include <QtCore/qset.h>
 
+#include <functional>
+
 namespace WTF {
 class BumpPointerAllocator;
 class PageAllocation;
@@ -126,6 +128,8 @@ struct Module;
 };
 
 struct Function;
+struct MegamorphicLookupCache;
+struct LookupStatistics;
 
 namespace Promise {
 class ReactionHandler;
@@ -502,6 +506,13 @@ public:
     quint32 m_engineId = 0;
 
     RegExpCache *regExpCache = nullptr;
+    MegamorphicLookupCache *megamorphicLookupCache = nullptr;
+    LookupStatistics *lookupStatistics = nullptr;
+
+    // The flattened string that has room left in its text buffer for appending
+    // in place. Reset by the garbage collector if the string dies. Use
+    // setAppendableString() to change it, so that the room is accounted for.
+    Heap::String *appendableString = nullptr;
 
     // Scarce resources are "exceptionally high cost" QVariant types where allowing the
     // normal JavaScript GC to clean them up is likely to lead to out-of-memory or other
@@ -566,7 +577,9 @@ public:
 
     Heap::String *newString(char16_t c) { return newString(QChar(c)); }
     Heap::String *newString(const QString &s = QString());
+    void setAppendableString(Heap::String *string);
     Heap::String *newIdentifier(const QString &text);
+    Heap::String *newIdentifier(QLatin1StringView text);
 
     Heap::Object *newStringObject(const String *string);
     Heap::Object *newSymbolObject(const Symbol *symbol);
@@ -580,6 +593,8 @@ public:
 
     Heap::ArrayBuffer *newArrayBuffer(const QByteArray &array);
     Heap::ArrayBuffer *newArrayBuffer(size_t length);
+    Heap::ArrayBuffer *newArrayBuffer(const char *data, size_t length, std::function<void()> release);
+    Heap::ArrayBuffer *newArrayBufferFromFile(const QString &fileName);
 
     Heap::DateObject *newDateObject(double dateTime);
     Heap::DateObject *newDateObject(const QDateTime &dateTime);
@@ -3,6 +3,14 @@
 
 #include "qv4estable_p.h"
 #include "qv4object_p.h"
+#include "qv4qmetaobjectwrapper_p.h"
+#include "qv4qobjectwrapper_p.h"
+
+#include <private/qqmltypewrapper_p.h>
+
+#include <QtCore/qhashfunctions.h>
+
+#include <algorithm>
 
 using namespace QV4;
 
@@ -10,26 +18,179 @@ using namespace QV4;
 // is a little different from most; it requires nonlinear access, and must also
 // preserve the order of insertion of items in a deterministic way.
 //
-// This class implements those requirements, except for fast access: that
-// will be addressed in a followup patch.
+// Entries are appended to dense arrays, which gives us the iteration order for
+// free. Lookups go through a separate open addressing index that maps a hash
+// to a position in those arrays. The hash of every entry is kept next to it,
+// so that growing the table never has to hash any of the keys again, and a
+// probe only has to compare keys whose hashes match.
+//
+// Removing an entry only leaves a hole behind, so positions are stable and
+// removal is O(1). Holes are squeezed out the next time the table runs out of
+// space. Iterators, which can be suspended while the table is modified, don't
+// keep a position but the sequence number of the next entry they have to
+// visit, which doesn't change when entries move.
 
 ESTable::ESTable()
     : m_capacity(8)
 {
-    m_keys = (Value*)malloc(m_capacity * sizeof(Value));
-    m_values = (Value*)malloc(m_capacity * sizeof(Value));
-    memset(m_keys, 0, m_capacity);
-    memset(m_values, 0, m_capacity);
+    m_keys = (Value*)calloc(m_capacity, sizeof(Value));
+    m_values = (Value*)calloc(m_capacity, sizeof(Value));
+    m_hashes = (uint*)calloc(m_capacity, sizeof(uint));
+    m_sequenceNumbers = (quint64*)calloc(m_capacity, sizeof(quint64));
+    m_index = (uint*)calloc(2 * m_capacity, sizeof(uint));
 }
 
 ESTable::~ESTable()
 {
     free(m_keys);
     free(m_values);
+    free(m_hashes);
+    free(m_sequenceNumbers);
+    free(m_index);
     m_size = 0;
+    m_deleted = 0;
     m_capacity = 0;
     m_keys = nullptr;
     m_values = nullptr;
+    m_hashes = nullptr;
+    m_sequenceNumbers = nullptr;
+    m_index = nullptr;
+}
+
+// Wrappers of QObjects, and type wrappers of singletons and attached objects,
+// are equal to each other if they refer to the same object. Returns whether
+// \a m is such a wrapper, and stores the object in \a object.
+static bool wrappedObject(const Managed *m, QObject **object)
+{
+    if (const QObjectWrapper *wrapper = m->as<QObjectWrapper>()) {
+        *object = wrapper->object();
+        return true;
+    }
+    if (const QQmlTypeWrapper *typeWrapper = m->as<QQmlTypeWrapper>()) {
+        *object = typeWrapper->toVariant().value<QObject *>();
+        return true;
+    }
+    return false;
+}
+
+// Keys that are considered the same by sameValueZero have to end up with the
+// same hash. Strings use their cached hash and numbers are hashed by their
+// double value, as 1 and 1.0 might be encoded differently. Objects that define
+// their own notion of equality are hashed by what they compare, if that is an
+// identity. Variants, value types and sequences compare by value, so they all
+// share one hash.
+uint ESTable::hashKey(const Value &key)
+{
+    if (const String *s = key.stringValue())
+        return s->hashValue();
+
+    if (const Managed *m = key.managed()) {
+        if (m->vtable()->isEqualTo == Managed::staticVTable()->isEqualTo)
+            return uint(qHash(m->heapObject()));
+        QObject *object = nullptr;
+        if (wrappedObject(m, &object))
+            return uint(qHash(object));
+        if (const QMetaObjectWrapper *wrapper = m->as<QMetaObjectWrapper>())
+            return uint(qHash(wrapper->metaObject()));
+        return 0;
+    }
+
+    if (key.isNumber()) {
+        const double d = key.asDouble();
+        if (std::isnan(d))
+            return 1;
+        return uint(qHash(d == 0 ? 0.0 : d));
+    }
+
+    return uint(qHash(key.rawValue()));
+}
+
+// Returns the position of \a key, or m_size if the key isn't in the table.
+uint ESTable::find(const Value &key, uint hash) const
+{
+    const uint mask = 2 * m_capacity - 1;
+    for (uint slot = hash & mask; m_index[slot]; slot = (slot + 1) & mask) {
+        const uint position = m_index[slot] - 1;
+        if (m_hashes[position] == hash && !m_keys[position].isEmpty()
+                && m_keys[position].sameValueZero(key)) {
+            return position;
+        }
+    }
+
+    // Wrappers of deleted objects are equal to each other, but may have been
+    // inserted under the hash of the object they wrapped at the time.
+    QObject *object = nullptr;
+    if (const Managed *m = key.managed(); m && wrappedObject(m, &object) && !object) {
+        for (uint position = 0; position < m_size; ++position) {
+            if (!m_keys[position].isEmpty() && m_keys[position].sameValueZero(key))
+                return position;
+        }
+    }
+    return m_size;
+}
+
+void ESTable::insertIntoIndex(uint position)
+{
+    const uint mask = 2 * m_capacity - 1;
+    uint slot = m_hashes[position] & mask;
+    while (m_index[slot])
+        slot = (slot + 1) & mask;
+    m_index[slot] = position + 1;
+}
+
+// Squeezes the holes out of the entry arrays, resizes them to \a newCapacity
+// and rebuilds the index from the stored hashes.
+void ESTable::compact(uint newCapacity)
+{
+    Q_ASSERT(newCapacity >= m_size - m_deleted);
+    Q_ASSERT((newCapacity & (newCapacity - 1)) == 0);
+
+    if (m_deleted) {
+        // Entries only move to the left. An observer that is on a hole was
+        // looking at a removed entry, and has to continue after the live
+        // entry in front of it.
+        for (ShiftObserver *ob : m_observers) {
+            Q_ASSERT(ob);
+            if (ob->pivot == ShiftObserver::OUT_OF_TABLE || ob->pivot >= m_size)
+                continue;
+            uint live = 0;
+            for (uint i = 0; i < ob->pivot; ++i) {
+                if (!m_keys[i].isEmpty())
+                    ++live;
+            }
+            if (!m_keys[ob->pivot].isEmpty())
+                ob->pivot = live;
+            else
+                ob->pivot = live == 0 ? ShiftObserver::OUT_OF_TABLE : live - 1;
+        }
+
+        uint toIdx = 0;
+        for (uint idx = 0; idx < m_size; ++idx) {
+            if (m_keys[idx].isEmpty())
+                continue;
+            m_keys[toIdx] = m_keys[idx];
+            m_values[toIdx] = m_values[idx];
+            m_hashes[toIdx] = m_hashes[idx];
+            m_sequenceNumbers[toIdx] = m_sequenceNumbers[idx];
+            ++toIdx;
+        }
+        m_size = toIdx;
+        m_deleted = 0;
+    }
+
+    if (newCapacity != m_capacity) {
+        m_capacity = newCapacity;
+        m_keys = (Value*)realloc(m_keys, m_capacity * sizeof(Value));
+        m_values = (Value*)realloc(m_values, m_capacity * sizeof(Value));
+        m_hashes = (uint*)realloc(m_hashes, m_capacity * sizeof(uint));
+        m_sequenceNumbers = (quint64*)realloc(m_sequenceNumbers, m_capacity * sizeof(quint64));
+        free(m_index);
+        m_index = (uint*)malloc(2 * m_capacity * sizeof(uint));
+    }
+
+    memset(m_index, 0, 2 * m_capacity * sizeof(uint));
+    for (uint i = 0; i < m_size; ++i)
+        insertIntoIndex(i);
 }
 
 void ESTable::markObjects(MarkStack *s, bool isWeakMap)
@@ -46,6 +207,8 @@ void ESTable::markObjects(MarkStack *s, bool isWeakMap)
 void ESTable::clear()
 {
     m_size = 0;
+    m_deleted = 0;
+    memset(m_index, 0, 2 * m_capacity * sizeof(uint));
 
     std::for_each(m_observers.begin(), m_observers.end(), [](ShiftObserver* ob){
         Q_ASSERT(ob);
@@ -57,20 +220,17 @@ void ESTable::clear()
 // normalized, as required by the ES spec.
 void ESTable::set(const Value &key, const Value &value)
 {
-    for (uint i = 0; i < m_size; ++i) {
-        if (m_keys[i].sameValueZero(key)) {
-            m_values[i] = value;
-            return;
-        }
+    const uint hash = hashKey(key);
+    const uint position = find(key, hash);
+    if (position < m_size) {
+        m_values[position] = value;
+        return;
     }
 
     if (m_capacity == m_size) {
-        uint oldCap = m_capacity;
-        m_capacity *= 2;
-        m_keys = (Value*)realloc(m_keys, m_capacity * sizeof(Value));
-        m_values = (Value*)realloc(m_values, m_capacity * sizeof(Value));
-        memset(m_keys + oldCap, 0, m_capacity - oldCap);
-        memset(m_values + oldCap, 0, m_capacity - oldCap);
+        // Reuse the space taken by holes if they make up a good part of the
+        // table, grow otherwise.
+        compact(m_deleted >= m_size / 2 ? m_capacity : m_capacity * 2);
     }
 
     Value nk = key;
@@ -81,6 +241,9 @@ void ESTable::set(const Value &key, const Value &value)
 
     m_keys[m_size] = nk;
     m_values[m_size] = value;
+    m_hashes[m_size] = hash;
+    m_sequenceNumbers[m_size] = m_nextSequenceNumber++;
+    insertIntoIndex(m_size);
 
     m_size++;
 }
@@ -88,24 +251,18 @@ void ESTable::set(const Value &key, const Value &value)
 // Returns true if the table contains \a key, false otherwise.
 bool ESTable::has(const Value &key) const
 {
-    for (uint i = 0; i < m_size; ++i) {
-        if (m_keys[i].sameValueZero(key))
-            return true;
-    }
-
-    return false;
+    return find(key, hashKey(key)) < m_size;
 }
 
 // Fetches the value for the given \a key, and if \a hasValue is passed in,
 // it is set depending on whether or not the given key was found.
 ReturnedValue ESTable::get(const Value &key, bool *hasValue) const
 {
-    for (uint i = 0; i < m_size; ++i) {
-        if (m_keys[i].sameValueZero(key)) {
-            if (hasValue)
-                *hasValue = true;
-            return m_values[i].asReturnedValue();
-        }
+    const uint position = find(key, hashKey(key));
+    if (position < m_size) {
+        if (hasValue)
+            *hasValue = true;
+        return m_values[position].asReturnedValue();
     }
 
     if (hasValue)
@@ -116,56 +273,88 @@ ReturnedValue ESTable::get(const Value &key, bool *hasValue) const
 // Removes the given \a key from the table
 bool ESTable::remove(const Value &key)
 {
-    for (uint index = 0; index < m_size; ++index) {
-        if (m_keys[index].sameValueZero(key)) {
-            // Remove the element at |index| by moving all elements to the right
-            // of |index| one place to the left.
-            size_t count = (m_size - (index + 1)) * sizeof(Value);
-            memmove(m_keys + index, m_keys + index + 1, count);
-            memmove(m_values + index, m_values + index + 1, count);
-            m_size--;
-
-            std::for_each(m_observers.begin(), m_observers.end(), [index](ShiftObserver* ob) {
-                Q_ASSERT(ob);
-                if (index <= ob->pivot && ob->pivot != ShiftObserver::OUT_OF_TABLE)
-                    ob->pivot = ob->pivot == 0 ? ShiftObserver::OUT_OF_TABLE : ob->pivot - 1;
-            });
-
-            return true;
-        }
-    }
-    return false;
+    const uint position = find(key, hashKey(key));
+    if (position == m_size)
+        return false;
+
+    // Leave a hole behind. The index keeps pointing to it, so that probing
+    // continues past it, until the next compaction. Positions of the other
+    // entries don't change, so observers don't need to be adjusted.
+    m_keys[position] = Value::emptyValue();
+    m_values[position] = Value::undefinedValue();
+    ++m_deleted;
+    return true;
 }
 
-// Returns the size of the table. Note that the size may not match the underlying allocation.
+// Returns the number of entries in the table. Note that the size may not match
+// the underlying allocation.
 uint ESTable::size() const
 {
-    return m_size;
+    return m_size - m_deleted;
 }
 
-// Retrieves a key and value for a given \a idx, and places them in \a key and
-// \a value. They must be valid pointers.
-void ESTable::iterate(uint idx, Value *key, Value *value)
+// Retrieves the key and value of the first entry at or after position \a idx,
+// and places them in \a key and \a value. They must be valid pointers. \a idx
+// is updated to the position of the entry. Returns false if there is no such
+// entry.
+bool ESTable::iterate(uint *idx, Value *key, Value *value) const
 {
-    Q_ASSERT(idx < m_size);
+    Q_ASSERT(idx);
     Q_ASSERT(key);
     Q_ASSERT(value);
-    *key = m_keys[idx];
-    *value = m_values[idx];
+    for (uint i = *idx; i < m_size; ++i) {
+        if (m_keys[i].isEmpty())
+            continue;
+        *idx = i;
+        *key = m_keys[i];
+        *value = m_values[i];
+        return true;
+    }
+    return false;
+}
+
+// Like iterate(), but for iterators that can be suspended while the table is
+// modified. Retrieves the first entry with a sequence number of at least
+// \a sequenceNumber, and updates \a sequenceNumber and \a idx to the ones of
+// that entry. \a idx is only used as a hint where to start looking, as
+// entries may have moved since it was retrieved.
+bool ESTable::iterate(uint *idx, quint64 *sequenceNumber, Value *key, Value *value) const
+{
+    Q_ASSERT(idx);
+    Q_ASSERT(sequenceNumber);
+
+    uint position = *idx;
+    const bool hintIsValid = position <= m_size
+            && (position == m_size || m_sequenceNumbers[position] >= *sequenceNumber)
+            && (position == 0 || m_sequenceNumbers[position - 1] < *sequenceNumber);
+    if (!hintIsValid) {
+        position = std::lower_bound(m_sequenceNumbers, m_sequenceNumbers + m_size,
+                                    *sequenceNumber) - m_sequenceNumbers;
+    }
+
+    if (!iterate(&position, key, value))
+        return false;
+
+    *idx = position;
+    *sequenceNumber = m_sequenceNumbers[position];
+    return true;
 }
 
 void ESTable::removeUnmarkedKeys()
 {
-    uint idx = 0;
-    uint toIdx = 0;
-    for (; idx < m_size; ++idx) {
+    bool removed = false;
+    for (uint idx = 0; idx < m_size; ++idx) {
+        if (m_keys[idx].isEmpty())
+            continue;
         Q_ASSERT(m_keys[idx].isObject());
         Object &o = static_cast<Object &>(m_keys[idx]);
-        if (o.d()->isMarked()) {
-            m_keys[toIdx] = m_keys[idx];
-            m_values[toIdx] = m_values[idx];
-            ++toIdx;
+        if (!o.d()->isMarked()) {
+            m_keys[idx] = Value::emptyValue();
+            m_values[idx] = Value::undefinedValue();
+            ++m_deleted;
+            removed = true;
         }
     }
-    m_size = toIdx;
+    if (removed)
+        compact(m_capacity);
 }
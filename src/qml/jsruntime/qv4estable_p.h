@@ -58,7 +58,8 @@ public:
     ReturnedValue get(const Value &k, bool *hasValue = nullptr) const;
     bool remove(const Value &k);
     uint size() const;
-    void iterate(uint idx, Value *k, Value *v);
+    bool iterate(uint *idx, Value *k, Value *v) const;
+    bool iterate(uint *idx, quint64 *sequenceNumber, Value *k, Value *v) const;
 
     void removeUnmarkedKeys();
 
@@ -73,10 +74,27 @@ public:
 private:
     friend class ::tst_qv4estable;
 
+    static uint hashKey(const Value &key);
+    uint find(const Value &key, uint hash) const;
+    void insertIntoIndex(uint position);
+    void compact(uint newCapacity);
+
+    // Entries live in insertion order in m_keys/m_values/m_hashes. Removed
+    // entries leave a hole (an empty key) behind until the next compaction.
+    // m_sequenceNumbers numbers the entries in the order they were inserted,
+    // and is never reset, so that iterators can find their place again after
+    // a compaction or clear().
+    // m_index is an open addressing table (linear probing) of twice the
+    // capacity holding position + 1 of each entry, 0 meaning unused.
     Value *m_keys = nullptr;
     Value *m_values = nullptr;
+    uint *m_hashes = nullptr;
+    quint64 *m_sequenceNumbers = nullptr;
+    uint *m_index = nullptr;
     uint m_size = 0;
+    uint m_deleted = 0;
     uint m_capacity = 0;
+    quint64 m_nextSequenceNumber = 0;
 
     std::vector<ShiftObserver*> m_observers;
 };
@@ -92,6 +92,10 @@ void ExecutableCompilationUnit::populate()
     for (uint i = 0; i < stringCount; ++i)
         runtimeStrings[i] = engine->newString(stringAt(i));
 
+    // Units with static data were compiled ahead of time or loaded from the
+    // disk cache. Their regular expressions are part of the application and
+    // likely to be used, so don't make them wait for the JIT.
+    const bool jitRegExpsEagerly = data->flags & CompiledData::Unit::StaticData;
     runtimeRegularExpressions
             = new QV4::Value[data->regexpTableSize];
     for (uint i = 0; i < data->regexpTableSize; ++i) {
@@ -100,6 +104,8 @@ void ExecutableCompilationUnit::populate()
         const CompiledData::RegExp::Flags flags = static_cast<CompiledData::RegExp::Flags>(f);
         runtimeRegularExpressions[i] = QV4::RegExp::create(
                 engine, stringAt(re->stringIndex()), flags);
+        if (jitRegExpsEagerly)
+            static_cast<QV4::RegExp &>(runtimeRegularExpressions[i]).jitOnFirstMatch();
     }
 
     if (data->lookupTableSize) {
@@ -95,6 +95,10 @@ public:
     // first nArguments names in internalClass are the actual arguments
     QV4::WriteBarrier::Pointer<Heap::InternalClass> internalClass;
     int interpreterCallCount = 0;
+    int interpreterBackEdgeCount = 0;
+    // Estimated number of members of objects constructed by this function, based
+    // on the previous instances. New instances are allocated with room for that many.
+    uint constructedMemberCount = 0;
     quint16 nFormals = 0;
     enum Kind : quint8 { JsUntyped, JsTyped, AotCompiled, Eval };
     Kind kind = JsUntyped;
@@ -444,6 +444,11 @@ ReturnedValue FunctionPrototype::method_hasInstance(const FunctionObject *, cons
 
 DEFINE_OBJECT_VTABLE(ScriptFunction);
 
+// Objects created by a constructor get room for at most this many members up front.
+static const uint MaxConstructedMemberCount = 32;
+// The estimate grows by doubling, starting from this many members.
+static const uint InitialConstructedMemberCount = 4;
+
 ReturnedValue ScriptFunction::virtualCallAsConstructor(const FunctionObject *fo, const Value *argv, int argc, const Value *newTarget)
 {
     ExecutionEngine *v4 = fo->engine();
@@ -461,7 +466,9 @@ ReturnedValue ScriptFunction::virtualCallAsConstructor(const FunctionObject *fo,
         if (o)
             ic = ic->changePrototype(o->d());
     }
-    ScopedValue thisObject(scope, v4->memoryManager->allocObject<Object>(ic));
+    Function *function = f->function();
+    ScopedObject thisObject(scope, v4->memoryManager->allocObjectWithCapacity<Object>(
+                                       function->constructedMemberCount, ic->d()));
 
     JSTypesStackFrame frame;
     frame.init(f->function(), argv, argc);
@@ -478,8 +485,16 @@ ReturnedValue ScriptFunction::virtualCallAsConstructor(const FunctionObject *fo,
 
     if (Q_UNLIKELY(v4->hasException))
         return Encode::undefined();
-    else if (!Value::fromReturnedValue(result).isObject())
+    else if (!Value::fromReturnedValue(result).isObject()) {
+        // Follow instances that end up smaller right away, but grow the estimate only
+        // gradually and up to a limit, so that a single large instance doesn't make all
+        // later ones large.
+        const uint size = qMin(thisObject->internalClass()->size, MaxConstructedMemberCount);
+        const uint count = function->constructedMemberCount;
+        function->constructedMemberCount
+                = size <= count ? size : qMin(size, qMax(2 * count, InitialConstructedMemberCount));
         return thisObject->asReturnedValue();
+    }
     return result;
 }
 
@@ -111,6 +111,23 @@ Heap::String *IdentifierTable::insertString(const QString &s)
     return resolveStringEntry(s, hash, subtype);
 }
 
+Heap::String *IdentifierTable::insertString(QLatin1StringView s)
+{
+    uint subtype;
+    const uint hash = String::createHashValue(s.data(), int(s.size()), &subtype);
+    if (subtype != Heap::String::StringType_ArrayIndex) {
+        // The identifier most likely exists already. Find it without converting to UTF-16.
+        uint idx = hash % alloc;
+        while (Heap::StringOrSymbol *e = entriesByHash[idx]) {
+            if (e->stringHash == hash && e->toQString() == s)
+                return static_cast<Heap::String *>(e);
+            ++idx;
+            idx %= alloc;
+        }
+    }
+    return insertString(QString(s));
+}
+
 Heap::String *IdentifierTable::resolveStringEntry(const QString &s, uint hash, uint subtype)
 {
     uint idx = hash % alloc;
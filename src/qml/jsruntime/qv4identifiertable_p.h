@@ -44,6 +44,7 @@ public:
     ~IdentifierTable();
 
     Heap::String *insertString(const QString &s);
+    Heap::String *insertString(QLatin1StringView s);
     Heap::Symbol *insertSymbol(const QString &s);
 
     PropertyKey asPropertyKey(const Heap::String *str) {
@@ -289,6 +289,19 @@ void InternalClass::destroy()
     Base::destroy();
 }
 
+/*!
+    \internal
+    Removes the transition leading to this class from its parent, if the parent
+    survives the current gc cycle. Called on unmarked classes before sweeping.
+ */
+void InternalClass::unlinkFromParent()
+{
+    if (parent && parent->engine && parent->isMarked()) {
+        parent->removeChildEntry(this);
+        parent = nullptr;
+    }
+}
+
 ReturnedValue InternalClass::keyAt(uint index) const
 {
     PropertyKey key = nameMap.at(index);
@@ -350,6 +350,7 @@ struct InternalClass : Base {
     void init(ExecutionEngine *engine);
     void init(InternalClass *other);
     void destroy();
+    void unlinkFromParent();
 
     Q_QML_EXPORT ReturnedValue keyAt(uint index) const;
     Q_REQUIRED_RESULT InternalClass *nonExtensible();
@@ -137,6 +137,7 @@ ReturnedValue JsonParser::parse(QJsonParseError *error)
     eatSpace();
 
     Scope scope(engine);
+    shapeHints = scope.alloc(ShapeHintDepth);
     ScopedValue v(scope);
     if (!parseValue(v)) {
 #ifdef PARSER_DEBUG
@@ -180,9 +181,21 @@ ReturnedValue JsonParser::parseObject()
 
     ScopedObject o(scope, engine->newObject());
 
+    // Objects on the same nesting level usually have the same keys in the same
+    // order, as in an array of records. Optimistically give the new object the
+    // internal class of its predecessor so that the members can be stored
+    // without any transitions. dropShape() reverts this on the first mismatch.
+    ShapeMatch match;
+    if (nestingLevel <= ShapeHintDepth && shapeHints[nestingLevel - 1].isManaged()) {
+        match.base = o->internalClass();
+        match.shape = static_cast<Heap::InternalClass *>(
+                shapeHints[nestingLevel - 1].heapObject());
+        o->setInternalClass(match.shape);
+    }
+
     QChar token = nextToken();
     while (token.unicode() == Quote) {
-        if (!parseMember(o))
+        if (!parseMember(o, &match))
             return Encode::undefined();
         token = nextToken();
         if (token.unicode() != ValueSeparator)
@@ -200,6 +213,12 @@ ReturnedValue JsonParser::parseObject()
         return Encode::undefined();
     }
 
+    if (match.shape && match.matched < match.shape->size)
+        dropShape(o, &match);
+
+    if (nestingLevel <= ShapeHintDepth)
+        shapeHints[nestingLevel - 1] = Value::fromHeapObject(o->internalClass());
+
     END;
 
     --nestingLevel;
@@ -209,7 +228,7 @@ ReturnedValue JsonParser::parseObject()
 /*
     member = string name-separator value
 */
-bool JsonParser::parseMember(Object *o)
+bool JsonParser::parseMember(Object *o, ShapeMatch *match)
 {
     BEGIN << "parseMember";
     Scope scope(engine);
@@ -222,23 +241,58 @@ bool JsonParser::parseMember(Object *o)
         lastError = QJsonParseError::MissingNameSeparator;
         return false;
     }
+
+    if (match->shape) {
+        bool sameKey = false;
+        if (match->matched < match->shape->size) {
+            const QStringPrivate &expected
+                    = match->shape->nameMap.at(match->matched).asStringOrSymbol()->text();
+            sameKey = QStringView(expected.data(), expected.size) == key;
+        }
+        if (!sameKey)
+            dropShape(o, match);
+    }
+
     ScopedValue val(scope);
     if (!parseValue(val))
         return false;
 
-    ScopedString s(scope, engine->newString(key));
-    PropertyKey skey = s->toPropertyKey();
+    if (match->shape) {
+        o->setProperty(match->matched++, val);
+        END;
+        return true;
+    }
+
+    // Look up the identifier directly, there is no need for a string on the heap.
+    PropertyKey skey = engine->identifierTable->asPropertyKey(key);
     if (skey.isArrayIndex()) {
         o->put(skey.asArrayIndex(), val);
     } else {
         // avoid trouble with properties named __proto__
-        o->insertMember(s, val);
+        InternalClassEntry idx;
+        Heap::InternalClass::addMember(o, skey, Attr_Data, &idx);
+        o->setProperty(idx.index, val);
     }
 
     END;
     return true;
 }
 
+/*
+    Gives the object the internal class that holds only the members matched so
+    far and continues with regular member insertion.
+*/
+void JsonParser::dropShape(Object *o, ShapeMatch *match)
+{
+    // All the intermediate classes are ancestors of the shape, which the object
+    // keeps alive until we replace it.
+    Heap::InternalClass *ic = match->base;
+    for (uint i = 0; i < match->matched; ++i)
+        ic = ic->addMember(match->shape->nameMap.at(i), Attr_Data);
+    o->setInternalClass(ic);
+    match->shape = nullptr;
+}
+
 /*
     array = begin-array [ value *( value-separator value ) ] end-array
 */
@@ -437,7 +491,7 @@ bool JsonParser::parseNumber(Value *val)
             ++json;
     }
 
-    QString number(start, json - start);
+    const QStringView number(start, json - start);
     DEBUG << "numberstring" << number;
 
     if (isInt) {
@@ -545,11 +599,54 @@ static inline bool scanEscapeSequence(const QChar *&json, const QChar *end, uint
 }
 
 
+/*
+    Returns the first character at or after \a json that needs special treatment
+    inside a string: a quotation mark, a backslash or a control character.
+    Checks four characters at a time, using the usual "has less than" bit trick
+    on 16 bit lanes.
+*/
+static inline const QChar *scanPlainCharacters(const QChar *json, const QChar *end)
+{
+    constexpr quint64 Lanes = Q_UINT64_C(0x0001000100010001);
+    constexpr quint64 HighBits = Lanes * 0x8000;
+    const auto hasLess = [](quint64 chunk, quint64 n) {
+        return (chunk - Lanes * n) & ~chunk & HighBits;
+    };
+
+    while (end - json >= 4) {
+        quint64 chunk;
+        memcpy(&chunk, json, sizeof(chunk));
+        if (hasLess(chunk, 0x20)
+                || hasLess(chunk ^ (Lanes * u'"'), 1)
+                || hasLess(chunk ^ (Lanes * u'\\'), 1)) {
+            break;
+        }
+        json += 4;
+    }
+
+    while (json < end) {
+        const char16_t ch = json->unicode();
+        if (ch == u'"' || ch == u'\\' || ch <= 0x1f)
+            break;
+        ++json;
+    }
+    return json;
+}
+
 bool JsonParser::parseString(QString *string)
 {
     BEGIN << "parse string stringPos=" << json;
 
     while (json < end) {
+        // Copy runs of plain characters in one go.
+        const QChar *plain = scanPlainCharacters(json, end);
+        if (plain != json) {
+            string->append(json, plain - json);
+            json = plain;
+            if (json == end)
+                break;
+        }
+
         if (*json == u'"')
             break;
         else if (*json == u'\\') {
@@ -564,12 +661,9 @@ bool JsonParser::parseString(QString *string)
                 *string += QChar(ch);
             }
         } else {
-            if (json->unicode() <= 0x1f) {
-                lastError = QJsonParseError::IllegalEscapeSequence;
-                return false;
-            }
-            *string += *json;
-            ++json;
+            // scanPlainCharacters() only stops at control characters otherwise.
+            lastError = QJsonParseError::IllegalEscapeSequence;
+            return false;
         }
     }
     ++json;
@@ -590,10 +684,15 @@ struct Stringify
     FunctionObject *replacerFunction;
     QV4::String *propertyList;
     int propertyListSize;
+    QV4::String *toJSON;
     QString gap;
     QString indent;
     QStack<Object *> stack;
 
+    // All values are serialized into this one buffer, rather than into
+    // temporary strings that are joined for each object and array.
+    QString result;
+
     bool stackContains(Object *o) {
         for (int i = 0; i < stack.size(); ++i)
             if (stack.at(i)->d() == o->d())
@@ -601,13 +700,13 @@ struct Stringify
         return false;
     }
 
-    Stringify(ExecutionEngine *e) : v4(e), replacerFunction(nullptr), propertyList(nullptr), propertyListSize(0) {}
+    Stringify(ExecutionEngine *e) : v4(e), replacerFunction(nullptr), propertyList(nullptr), propertyListSize(0), toJSON(nullptr) {}
 
-    QString Str(const QString &key, const Value &v);
-    QString JA(Object *a);
-    QString JO(Object *o);
+    bool Str(const QString &key, const Value &v);
+    void JA(Object *a);
+    void JO(Object *o);
 
-    QString makeMember(const QString &key, const Value &v);
+    void makeMember(const QString &key, const Value &v, bool *empty);
 };
 
 class [[nodiscard]] CallDepthAndCycleChecker
@@ -633,66 +732,71 @@ private:
     ExecutionEngineCallDepthRecorder<1> m_callDepthRecorder;
 };
 
-static QString quote(const QString &str)
+static void quote(QString *product, QStringView str)
 {
-    QString product;
-    const int length = str.size();
-    product.reserve(length + 2);
-    product += u'"';
-    for (int i = 0; i < length; ++i) {
-        QChar c = str.at(i);
-        switch (c.unicode()) {
+    *product += u'"';
+    const QChar *it = str.begin();
+    const QChar *end = str.end();
+    while (true) {
+        // Copy runs of characters that need no escaping in one go.
+        const QChar *plain = scanPlainCharacters(it, end);
+        product->append(it, plain - it);
+        if (plain == end)
+            break;
+
+        it = plain;
+        const char16_t c = (it++)->unicode();
+        switch (c) {
         case u'"':
-            product += QLatin1String("\\\"");
+            *product += QLatin1String("\\\"");
             break;
         case u'\\':
-            product += QLatin1String("\\\\");
+            *product += QLatin1String("\\\\");
             break;
         case u'\b':
-            product += QLatin1String("\\b");
+            *product += QLatin1String("\\b");
             break;
         case u'\f':
-            product += QLatin1String("\\f");
+            *product += QLatin1String("\\f");
             break;
         case u'\n':
-            product += QLatin1String("\\n");
+            *product += QLatin1String("\\n");
             break;
         case u'\r':
-            product += QLatin1String("\\r");
+            *product += QLatin1String("\\r");
             break;
         case u'\t':
-            product += QLatin1String("\\t");
+            *product += QLatin1String("\\t");
             break;
         default:
-            if (c.unicode() <= 0x1f) {
-                product += QLatin1String("\\u00");
-                product += (c.unicode() > 0xf ? u'1' : u'0') +
-                        QLatin1Char("0123456789abcdef"[c.unicode() & 0xf]);
-            } else {
-                product += c;
-            }
+            Q_ASSERT(c <= 0x1f);
+            *product += QLatin1String("\\u00");
+            *product += (c > 0xf ? u'1' : u'0');
+            *product += QLatin1Char("0123456789abcdef"[c & 0xf]);
         }
     }
-    product += u'"';
-    return product;
+    *product += u'"';
 }
 
-QString Stringify::Str(const QString &key, const Value &v)
+/*
+    Appends the serialization of \a v to the result. Returns false, without
+    appending anything, if \a v has no JSON representation.
+*/
+bool Stringify::Str(const QString &key, const Value &v)
 {
     Scope scope(v4);
 
     ScopedValue value(scope, v);
     ScopedObject o(scope, value);
     if (o) {
-        ScopedString s(scope, v4->newString(QStringLiteral("toJSON")));
-        ScopedFunctionObject toJSON(scope, o->get(s));
-        if (!!toJSON) {
+        ScopedFunctionObject toJSONFunction(scope, o->get(toJSON));
+        if (!!toJSONFunction) {
             JSCallArguments jsCallData(scope, 1);
             *jsCallData.thisObject = value;
             jsCallData.args[0] = v4->newString(key);
-            value = toJSON->call(jsCallData);
+            value = toJSONFunction->call(jsCallData);
             if (v4->hasException)
-                return QString();
+                return false;
         }
     }
 
@@ -711,7 +815,7 @@ QString Stringify::Str(const QString &key, const Value &v)
 
         value = replacerFunction->call(jsCallData);
         if (v4->hasException)
-            return QString();
+            return false;
     }
 
     o = value->asReturnedValue();
@@ -724,80 +828,97 @@ QString Stringify::Str(const QString &key, const Value &v)
             value = Encode(b->value());
     }
 
-    if (value->isNull())
-        return QStringLiteral("null");
-    if (value->isBoolean())
-        return value->booleanValue() ? QStringLiteral("true") : QStringLiteral("false");
-    if (value->isString())
-        return quote(value->stringValue()->toQString());
+    if (value->isNull()) {
+        result += QLatin1String("null");
+        return true;
+    }
+    if (value->isBoolean()) {
+        result += value->booleanValue() ? QLatin1String("true") : QLatin1String("false");
+        return true;
+    }
+    if (value->isString()) {
+        quote(&result, value->stringValue()->toQString());
+        return true;
+    }
 
     if (value->isNumber()) {
         double d = value->toNumber();
-        return std::isfinite(d) ? value->toQString() : QStringLiteral("null");
+        if (std::isfinite(d))
+            result += value->toQString();
+        else
+            result += QLatin1String("null");
+        return true;
     }
 
     if (const QV4::VariantObject *v = value->as<QV4::VariantObject>()) {
-        return quote(v->d()->data().toString());
+        quote(&result, v->d()->data().toString());
+        return true;
     }
 
     o = value->asReturnedValue();
     if (o) {
         if (!o->as<FunctionObject>()) {
-            if (o->isArrayLike()) {
-                return JA(o.getPointer());
-            } else {
-                return JO(o);
-            }
+            if (o->isArrayLike())
+                JA(o.getPointer());
+            else
+                JO(o);
+            return true;
         }
     }
 
-    return QString();
+    return false;
 }
 
-QString Stringify::makeMember(const QString &key, const Value &v)
+void Stringify::makeMember(const QString &key, const Value &v, bool *empty)
 {
-    QString strP = Str(key, v);
-    if (!strP.isEmpty()) {
-        QString member = quote(key) + u':';
-        if (!gap.isEmpty())
-            member += u' ';
-        member += strP;
-        return member;
+    // Write the separator and the key right away, and take them back if the
+    // value turns out not to be serializable.
+    const qsizetype position = result.size();
+    if (!*empty)
+        result += u',';
+    if (!gap.isEmpty()) {
+        result += u'\n';
+        result += indent;
     }
-    return QString();
+    quote(&result, key);
+    result += u':';
+    if (!gap.isEmpty())
+        result += u' ';
+
+    if (Str(key, v))
+        *empty = false;
+    else
+        result.truncate(position);
 }
 
-QString Stringify::JO(Object *o)
+void Stringify::JO(Object *o)
 {
     CallDepthAndCycleChecker check(this, o);
     if (check.foundProblem())
-        return QString();
+        return;
 
     Scope scope(v4);
 
-    QString result;
     stack.push(o);
     QString stepback = indent;
     indent += gap;
 
-    QStringList partial;
+    result += u'{';
+    bool empty = true;
     if (!propertyListSize) {
         ObjectIterator it(scope, o, ObjectIterator::EnumerableOnly);
         ScopedValue name(scope);
 
         ScopedValue val(scope);
-        while (1) {
+        while (!v4->hasException) {
             name = it.nextPropertyNameAsString(val);
             if (name->isNull())
                 break;
-            QString key = name->toQString();
-            QString member = makeMember(key, val);
-            if (!member.isEmpty())
-                partial += member;
+            makeMember(name->toQString(), val, &empty);
         }
     } else {
         ScopedValue v(scope);
-        for (int i = 0; i < propertyListSize; ++i) {
+        for (int i = 0; i < propertyListSize && !v4->hasException; ++i) {
             bool exists;
             String *s = propertyList + i;
             if (!s)
@@ -805,69 +926,56 @@ QString Stringify::JO(Object *o)
             v = o->get(s, &exists);
             if (!exists)
                 continue;
-            QString member = makeMember(s->toQString(), v);
-            if (!member.isEmpty())
-                partial += member;
+            makeMember(s->toQString(), v, &empty);
         }
     }
 
-    if (partial.isEmpty()) {
-        result = QStringLiteral("{}");
-    } else if (gap.isEmpty()) {
-        result = u'{' + partial.join(u',') + u'}';
-    } else {
-        QString separator = QLatin1String(",\n") + indent;
-        result = QLatin1String("{\n") + indent + partial.join(separator) + u'\n'
-                 + stepback + u'}';
+    if (!empty && !gap.isEmpty()) {
+        result += u'\n';
+        result += stepback;
     }
+    result += u'}';
 
     indent = stepback;
     stack.pop();
-    return result;
 }
 
-QString Stringify::JA(Object *a)
+void Stringify::JA(Object *a)
 {
     CallDepthAndCycleChecker check(this, a);
     if (check.foundProblem())
-        return QString();
+        return;
 
     Scope scope(a->engine());
 
-    QString result;
     stack.push(a);
     QString stepback = indent;
     indent += gap;
 
-    QStringList partial;
+    result += u'[';
     uint len = a->getLength();
     ScopedValue v(scope);
-    for (uint i = 0; i < len; ++i) {
+    for (uint i = 0; i < len && !v4->hasException; ++i) {
+        if (i > 0)
+            result += u',';
+        if (!gap.isEmpty()) {
+            result += u'\n';
+            result += indent;
+        }
         bool exists;
         v = a->get(i, &exists);
-        if (!exists) {
-            partial += QStringLiteral("null");
-            continue;
-        }
-        QString strP = Str(QString::number(i), v);
-        if (!strP.isEmpty())
-            partial += strP;
-        else
-            partial += QStringLiteral("null");
+        if (!exists || !Str(QString::number(i), v))
+            result += QLatin1String("null");
     }
 
-    if (partial.isEmpty()) {
-        result = QStringLiteral("[]");
-    } else if (gap.isEmpty()) {
-        result = u'[' + partial.join(u',') + u']';
-    } else {
-        QString separator = QLatin1String(",\n") + indent;
-        result = QLatin1String("[\n") + indent + partial.join(separator) + u'\n' + stepback + u']';
+    if (len > 0 && !gap.isEmpty()) {
+        result += u'\n';
+        result += stepback;
     }
+    result += u']';
 
     indent = stepback;
     stack.pop();
-    return result;
 }
 
 
@@ -907,6 +1015,8 @@ ReturnedValue JsonObject::method_stringify(const FunctionObject *b, const Value
 {
     Scope scope(b);
     Stringify stringify(scope.engine);
+    ScopedString toJSON(scope, scope.engine->newIdentifier(QStringLiteral("toJSON")));
+    stringify.toJSON = toJSON;
 
     ScopedObject o(scope, argc > 1 ? argv[1] : Value::undefinedValue());
     if (o) {
@@ -948,10 +1058,9 @@ ReturnedValue JsonObject::method_stringify(const FunctionObject *b, const Value
 
 
     ScopedValue arg0(scope, argc ? argv[0] : Value::undefinedValue());
-    QString result = stringify.Str(QString(), arg0);
-    if (result.isEmpty() || scope.hasException())
+    if (!stringify.Str(QString(), arg0) || scope.hasException())
         RETURN_UNDEFINED();
-    return Encode(scope.engine->newString(result));
+    return Encode(scope.engine->newString(stringify.result));
 }
 
 
@@ -83,18 +83,32 @@ private:
     inline bool eatSpace();
     inline QChar nextToken();
 
+    struct ShapeMatch {
+        Heap::InternalClass *base = nullptr;
+        Heap::InternalClass *shape = nullptr;
+        uint matched = 0;
+    };
+
     ReturnedValue parseObject();
     ReturnedValue parseArray();
-    bool parseMember(Object *o);
+    bool parseMember(Object *o, ShapeMatch *match);
     bool parseString(QString *string);
     bool parseValue(Value *val);
     bool parseNumber(Value *val);
 
+    void dropShape(Object *o, ShapeMatch *match);
+
+    enum { ShapeHintDepth = 16 };
+
     ExecutionEngine *engine;
     const QChar *head;
     const QChar *json;
     const QChar *end;
 
+    // The final internal class of the last object parsed on each of the first
+    // ShapeHintDepth nesting levels. Lives on the JS stack while parsing.
+    Value *shapeHints = nullptr;
+
     int nestingLevel;
     QJsonParseError::ParseError lastError;
 };
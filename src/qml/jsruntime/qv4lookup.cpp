@@ -6,14 +6,32 @@
 #include <private/qqmlvaluetypewrapper_p.h>
 #include <private/qv4functionobject_p.h>
 #include <private/qv4identifiertable_p.h>
+#include <private/qv4proxy_p.h>
 #include <private/qv4qobjectwrapper_p.h>
 #include <private/qv4runtime_p.h>
 #include <private/qv4stackframe_p.h>
 
+#include <QtCore/qloggingcategory.h>
+
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 using namespace QV4;
 
+Q_STATIC_LOGGING_CATEGORY(lcLookupStats, "qt.qml.lookup.statistics")
+
+static inline void recordSlowPath(const Lookup *lookup, ExecutionEngine *engine)
+{
+    if (Q_UNLIKELY(engine->lookupStatistics))
+        engine->lookupStatistics->recordSlowPath(lookup, engine);
+}
+
+static inline void recordResolve(const Lookup *lookup, ExecutionEngine *engine)
+{
+    if (Q_UNLIKELY(engine->lookupStatistics))
+        engine->lookupStatistics->recordResolve(lookup, engine);
+}
 
 void Lookup::resolveProtoGetter(PropertyKey name, const Heap::Object *proto)
 {
@@ -124,6 +142,7 @@ ReturnedValue Lookup::resolveGlobalGetter(ExecutionEngine *engine)
 
 ReturnedValue Lookup::getterGeneric(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
+    recordResolve(lookup, engine);
     if (const Object *o = object.as<Object>())
         return lookup->resolveGetter(engine, o);
     return lookup->resolvePrimitiveGetter(engine, object);
@@ -225,13 +244,15 @@ ReturnedValue Lookup::getterTwoClasses(Lookup *lookup, ExecutionEngine *engine,
 
         // If any of the above options were true, the propertyCache was inactive.
         second.releasePropertyCache();
+        lookup->call = Call::GetterMegamorphic;
+        return result;
     }
 
     lookup->call = Call::GetterQObjectPropertyFallback;
     return getterFallback(lookup, engine, object);
 }
 
-ReturnedValue Lookup::getterFallback(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+static ReturnedValue getFallback(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     QV4::Scope scope(engine);
     QV4::ScopedObject o(scope, object.toObject(scope.engine));
@@ -241,6 +262,12 @@ ReturnedValue Lookup::getterFallback(Lookup *lookup, ExecutionEngine *engine, co
     return o->get(name);
 }
 
+ReturnedValue Lookup::getterFallback(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    recordSlowPath(lookup, engine);
+    return getFallback(lookup, engine, object);
+}
+
 ReturnedValue Lookup::getter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     // we can safely cast to a QV4::Object here. If object is actually a string,
@@ -280,6 +307,40 @@ ReturnedValue Lookup::getterProto(Lookup *lookup, ExecutionEngine *engine, const
     return getterTwoClasses(lookup, engine, object);
 }
 
+static inline uint propertyIndex(const Heap::InternalClass *ic, uint offset, bool isInline)
+{
+    // Undo the offset calculation of Object::virtualResolveLookupGetter
+    return isInline
+            ? offset - ic->vtable->inlinePropertyOffset
+            : offset + ic->vtable->nInlineProperties;
+}
+
+static ReturnedValue upgradeToPolymorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    Heap::InternalClass *ic1 = lookup->objectLookupTwoClasses.ic;
+    Heap::InternalClass *ic2 = lookup->objectLookupTwoClasses.ic2;
+    const uint index1 = propertyIndex(
+            ic1, lookup->objectLookupTwoClasses.offset,
+            lookup->call != Lookup::Call::Getter0MemberDataGetter0MemberData);
+    const uint index2 = propertyIndex(
+            ic2, lookup->objectLookupTwoClasses.offset2,
+            lookup->call == Lookup::Call::Getter0InlineGetter0Inline);
+
+    // The lookup keeps ic1 and ic2 alive until we overwrite it below.
+    Scope scope(engine);
+    Scoped<MemberData> entries(
+            scope, MemberData::allocate(engine, 2 * Lookup::PolymorphicEntries));
+    entries->set(engine, 0, ic1);
+    entries->set(engine, 1, Value::fromInt32(index1));
+    entries->set(engine, 2, ic2);
+    entries->set(engine, 3, Value::fromInt32(index2));
+
+    lookup->objectLookupPolymorphic.entries.set(engine, entries->d());
+    lookup->objectLookupPolymorphic.unused = 0;
+    lookup->call = Lookup::Call::GetterPolymorphic;
+    return Lookup::getterPolymorphic(lookup, engine, object);
+}
+
 ReturnedValue Lookup::getter0Inlinegetter0Inline(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     // we can safely cast to a QV4::Object here. If object is actually a string,
@@ -291,8 +352,7 @@ ReturnedValue Lookup::getter0Inlinegetter0Inline(Lookup *lookup, ExecutionEngine
         if (lookup->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->inlinePropertyDataWithOffset(lookup->objectLookupTwoClasses.offset2)->asReturnedValue();
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return upgradeToPolymorphic(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getter0Inlinegetter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -306,8 +366,7 @@ ReturnedValue Lookup::getter0Inlinegetter0MemberData(Lookup *lookup, ExecutionEn
         if (lookup->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->memberData->values.data()[lookup->objectLookupTwoClasses.offset2].asReturnedValue();
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return upgradeToPolymorphic(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getter0MemberDatagetter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -321,8 +380,7 @@ ReturnedValue Lookup::getter0MemberDatagetter0MemberData(Lookup *lookup, Executi
         if (lookup->objectLookupTwoClasses.ic2 == o->internalClass)
             return o->memberData->values.data()[lookup->objectLookupTwoClasses.offset2].asReturnedValue();
     }
-    lookup->call = Call::GetterQObjectPropertyFallback;
-    return getterFallback(lookup, engine, object);
+    return upgradeToPolymorphic(lookup, engine, object);
 }
 
 ReturnedValue Lookup::getterProtoTwoClasses(Lookup *lookup, ExecutionEngine *engine, const Value &object)
@@ -344,6 +402,90 @@ ReturnedValue Lookup::getterProtoTwoClasses(Lookup *lookup, ExecutionEngine *eng
     return getterFallback(lookup, engine, object);
 }
 
+ReturnedValue Lookup::getterPolymorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    // we can safely cast to a QV4::Object here. If object is actually a string,
+    // the internal class won't match
+    Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
+    if (o) {
+        const Value *entries = lookup->objectLookupPolymorphic.entries->values.data();
+        for (uint i = 0; i < 2 * PolymorphicEntries; i += 2) {
+            if (entries[i].heapObject() == o->internalClass.get())
+                return o->propertyData(entries[i + 1].int_32())->asReturnedValue();
+        }
+    }
+
+    if (const Object *obj = object.as<Object>()) {
+        Lookup second;
+        memset(&second, 0, sizeof(Lookup));
+        second.nameIndex = lookup->nameIndex;
+        second.forCall = lookup->forCall;
+        second.call = Call::GetterGeneric;
+        const ReturnedValue result = second.resolveGetter(engine, obj);
+
+        // Re-check the call: resolving the getter may have run code that changed the lookup.
+        if (lookup->call == Call::GetterPolymorphic
+                && (second.call == Call::Getter0Inline || second.call == Call::Getter0MemberData)) {
+            Heap::MemberData *entries = lookup->objectLookupPolymorphic.entries;
+            for (uint i = 0; i < 2 * PolymorphicEntries; i += 2) {
+                if (!entries->values[i].isUndefined())
+                    continue;
+                Heap::InternalClass *ic = second.objectLookup.ic;
+                entries->values.set(engine, i, ic);
+                entries->values.set(engine, i + 1, Value::fromInt32(propertyIndex(
+                        ic, second.objectLookup.offset, second.call == Call::Getter0Inline)));
+                return result;
+            }
+        }
+
+        // Too many internal classes, or something that isn't a plain data property.
+        second.releasePropertyCache();
+        lookup->objectLookupPolymorphic.entries.clear();
+        lookup->call = Call::GetterMegamorphic;
+        return result;
+    }
+
+    lookup->objectLookupPolymorphic.entries.clear();
+    lookup->call = Call::GetterMegamorphic;
+    return getterFallback(lookup, engine, object);
+}
+
+ReturnedValue Lookup::getterMegamorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object)
+{
+    // Even hits in the engine wide cache are much slower than a lookup's own cache.
+    // Count all accesses, so that megamorphic sites show up in the statistics.
+    recordSlowPath(lookup, engine);
+
+    if (!engine->megamorphicLookupCache)
+        engine->megamorphicLookupCache = new MegamorphicLookupCache;
+    MegamorphicLookupCache *cache = engine->megamorphicLookupCache;
+
+    Heap::Object *o = static_cast<Heap::Object *>(object.heapObject());
+    if (!o)
+        return getFallback(lookup, engine, object);
+
+    const PropertyKey name = engine->identifierTable->asPropertyKey(
+            engine->currentStackFrame->v4Function->compilationUnit->runtimeStrings[lookup->nameIndex]);
+
+    // Only plain objects end up in the cache, and the internal class determines the vtable.
+    // Therefore, a hit means we can read the property directly.
+    uint index;
+    if (cache->find(o->internalClass.get(), name, &index))
+        return o->propertyData(index)->asReturnedValue();
+
+    const Object *obj = object.as<Object>();
+    if (obj && obj->vtable()->resolveLookupGetter == Object::staticVTable()->resolveLookupGetter
+            && !obj->as<ProxyObject>() && !name.isArrayIndex()) {
+        const auto found = o->internalClass->findValueOrGetter(name);
+        if (found.isValid() && found.attrs.isData()) {
+            cache->insert(o->internalClass.get(), name, found.index);
+            return o->propertyData(found.index)->asReturnedValue();
+        }
+    }
+
+    return getFallback(lookup, engine, object);
+}
+
 ReturnedValue Lookup::getterAccessor(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
     // we can safely cast to a QV4::Object here. If object is actually a string,
@@ -459,6 +601,7 @@ ReturnedValue Lookup::getterQObjectMethod(Lookup *lookup, ExecutionEngine *engin
 
 ReturnedValue Lookup::getterFallbackMethod(Lookup *lookup, ExecutionEngine *engine, const Value &object)
 {
+    recordSlowPath(lookup, engine);
     const auto revertLookup = [lookup, engine, &object]() {
         lookup->call = Call::GetterGeneric;
         return Lookup::getterGeneric(lookup, engine, object);
@@ -564,6 +707,7 @@ ReturnedValue Lookup::stringLengthGetter(Lookup *lookup, ExecutionEngine *engine
 
 ReturnedValue Lookup::globalGetterGeneric(Lookup *lookup, ExecutionEngine *engine)
 {
+    recordResolve(lookup, engine);
     return lookup->resolveGlobalGetter(engine);
 }
 
@@ -605,6 +749,7 @@ bool Lookup::resolveSetter(ExecutionEngine *engine, Object *object, const Value
 
 bool Lookup::setterGeneric(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value)
 {
+    recordResolve(lookup, engine);
     if (object.isObject())
         return lookup->resolveSetter(engine, static_cast<Object *>(&object), value);
 
@@ -654,6 +799,7 @@ bool Lookup::setterTwoClasses(Lookup *lookup, ExecutionEngine *engine, Value &ob
 
 bool Lookup::setterFallback(Lookup *lookup, ExecutionEngine *engine, Value &object, const Value &value)
 {
+    recordSlowPath(lookup, engine);
     QV4::Scope scope(engine);
     QV4::ScopedObject o(scope, object.toObject(scope.engine));
     if (!o)
@@ -741,4 +887,133 @@ bool Lookup::arrayLengthSetter(Lookup *, ExecutionEngine *engine, Value &object,
     return true;
 }
 
+bool LookupStatistics::isEnabled()
+{
+    return lcLookupStats().isDebugEnabled();
+}
+
+const char *LookupStatistics::callName(Lookup::Call call)
+{
+    switch (call) {
+    case Lookup::Call::ContextGetterContextObjectMethod: return "ContextGetterContextObjectMethod";
+    case Lookup::Call::ContextGetterContextObjectProperty: return "ContextGetterContextObjectProperty";
+    case Lookup::Call::ContextGetterGeneric: return "ContextGetterGeneric";
+    case Lookup::Call::ContextGetterIdObject: return "ContextGetterIdObject";
+    case Lookup::Call::ContextGetterIdObjectInParentContext: return "ContextGetterIdObjectInParentContext";
+    case Lookup::Call::ContextGetterInGlobalObject: return "ContextGetterInGlobalObject";
+    case Lookup::Call::ContextGetterInParentContextHierarchy: return "ContextGetterInParentContextHierarchy";
+    case Lookup::Call::ContextGetterScopeObjectMethod: return "ContextGetterScopeObjectMethod";
+    case Lookup::Call::ContextGetterScopeObjectProperty: return "ContextGetterScopeObjectProperty";
+    case Lookup::Call::ContextGetterScopeObjectPropertyFallback: return "ContextGetterScopeObjectPropertyFallback";
+    case Lookup::Call::ContextGetterScript: return "ContextGetterScript";
+    case Lookup::Call::ContextGetterSingleton: return "ContextGetterSingleton";
+    case Lookup::Call::ContextGetterType: return "ContextGetterType";
+    case Lookup::Call::ContextGetterValueSingleton: return "ContextGetterValueSingleton";
+    case Lookup::Call::GlobalGetterGeneric: return "GlobalGetterGeneric";
+    case Lookup::Call::GlobalGetterProto: return "GlobalGetterProto";
+    case Lookup::Call::GlobalGetterProtoAccessor: return "GlobalGetterProtoAccessor";
+    case Lookup::Call::Getter0Inline: return "Getter0Inline";
+    case Lookup::Call::Getter0InlineGetter0Inline: return "Getter0InlineGetter0Inline";
+    case Lookup::Call::Getter0InlineGetter0MemberData: return "Getter0InlineGetter0MemberData";
+    case Lookup::Call::Getter0MemberData: return "Getter0MemberData";
+    case Lookup::Call::Getter0MemberDataGetter0MemberData: return "Getter0MemberDataGetter0MemberData";
+    case Lookup::Call::GetterAccessor: return "GetterAccessor";
+    case Lookup::Call::GetterAccessorPrimitive: return "GetterAccessorPrimitive";
+    case Lookup::Call::GetterEnumValue: return "GetterEnumValue";
+    case Lookup::Call::GetterGeneric: return "GetterGeneric";
+    case Lookup::Call::GetterIndexed: return "GetterIndexed";
+    case Lookup::Call::GetterMegamorphic: return "GetterMegamorphic";
+    case Lookup::Call::GetterPolymorphic: return "GetterPolymorphic";
+    case Lookup::Call::GetterProto: return "GetterProto";
+    case Lookup::Call::GetterProtoAccessor: return "GetterProtoAccessor";
+    case Lookup::Call::GetterProtoAccessorTwoClasses: return "GetterProtoAccessorTwoClasses";
+    case Lookup::Call::GetterProtoPrimitive: return "GetterProtoPrimitive";
+    case Lookup::Call::GetterProtoTwoClasses: return "GetterProtoTwoClasses";
+    case Lookup::Call::GetterQObjectAttached: return "GetterQObjectAttached";
+    case Lookup::Call::GetterQObjectMethod: return "GetterQObjectMethod";
+    case Lookup::Call::GetterQObjectMethodFallback: return "GetterQObjectMethodFallback";
+    case Lookup::Call::GetterQObjectProperty: return "GetterQObjectProperty";
+    case Lookup::Call::GetterQObjectPropertyFallback: return "GetterQObjectPropertyFallback";
+    case Lookup::Call::GetterScopedEnum: return "GetterScopedEnum";
+    case Lookup::Call::GetterSingletonMethod: return "GetterSingletonMethod";
+    case Lookup::Call::GetterSingletonProperty: return "GetterSingletonProperty";
+    case Lookup::Call::GetterStringLength: return "GetterStringLength";
+    case Lookup::Call::GetterValueTypeProperty: return "GetterValueTypeProperty";
+    case Lookup::Call::Setter0Inline: return "Setter0Inline";
+    case Lookup::Call::Setter0MemberData: return "Setter0MemberData";
+    case Lookup::Call::Setter0Setter0: return "Setter0Setter0";
+    case Lookup::Call::SetterArrayLength: return "SetterArrayLength";
+    case Lookup::Call::SetterGeneric: return "SetterGeneric";
+    case Lookup::Call::SetterInsert: return "SetterInsert";
+    case Lookup::Call::SetterQObjectProperty: return "SetterQObjectProperty";
+    case Lookup::Call::SetterQObjectPropertyFallback: return "SetterQObjectPropertyFallback";
+    case Lookup::Call::SetterValueTypeProperty: return "SetterValueTypeProperty";
+    }
+
+    Q_UNREACHABLE_RETURN("");
+}
+
+void LookupStatistics::recordResolve(const Lookup *lookup, ExecutionEngine *engine)
+{
+    // Every lookup is resolved once. Only count resolving it again after its cache failed.
+    if (!resolvedLookups.contains(lookup)) {
+        resolvedLookups.insert(lookup);
+        return;
+    }
+    recordSlowPath(lookup, engine);
+}
+
+void LookupStatistics::recordSlowPath(const Lookup *lookup, ExecutionEngine *engine)
+{
+    ++slowPathCounts[lookup->call];
+
+    const CppStackFrame *frame = engine->currentStackFrame;
+    if (!frame)
+        return;
+
+    const QString source = frame->source();
+    const int line = frame->lineNumber();
+    const QString name = frame->v4Function->compilationUnit->runtimeStrings[lookup->nameIndex]
+            ->toQString();
+
+    Site &site = sites[source + u':' + QString::number(line) + u':' + name + u':'
+                       + QString::number(int(lookup->call))];
+    if (!site.slowPathCount) {
+        site.source = source;
+        site.line = line;
+        site.name = name;
+        site.call = lookup->call;
+    }
+    ++site.slowPathCount;
+}
+
+QList<LookupStatistics::Site> LookupStatistics::sitesBySlowPathCount() const
+{
+    QList<Site> result = sites.values();
+    std::sort(result.begin(), result.end(), [](const Site &a, const Site &b) {
+        return a.slowPathCount > b.slowPathCount;
+    });
+    return result;
+}
+
+void LookupStatistics::dump() const
+{
+    const QLoggingCategory &stats = lcLookupStats();
+    qDebug(stats) << "Qml lookup slow path statistics:";
+    qDebug(stats) << "By kind of lookup:";
+    for (auto it = slowPathCounts.cbegin(), end = slowPathCounts.cend(); it != end; ++it)
+        qDebug(stats).nospace() << "    " << callName(it.key()) << ": " << it.value();
+
+    enum { MaxReportedSites = 20 };
+    qDebug(stats) << "Most frequent sites:";
+    const QList<Site> bySlowPathCount = sitesBySlowPathCount();
+    for (qsizetype i = 0, end = std::min<qsizetype>(MaxReportedSites, bySlowPathCount.size());
+         i < end; ++i) {
+        const Site &site = bySlowPathCount[i];
+        qDebug(stats).nospace() << "    " << site.source << ":" << site.line << " "
+                                << site.name << " (" << callName(site.call) << "): "
+                                << site.slowPathCount;
+    }
+}
+
 QT_END_NAMESPACE
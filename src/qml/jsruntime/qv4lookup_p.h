@@ -21,6 +21,10 @@
 #include <private/qqmltypewrapper_p.h>
 #include <private/qv4mm_p.h>
 
+#include <QtCore/qhash.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qset.h>
+
 QT_BEGIN_NAMESPACE
 
 namespace QV4 {
@@ -36,6 +40,9 @@ using HeapObjectWrapper = WriteBarrier::HeapObjectWrapper<T, PhantomTag>;
 //       be trivially copyable. But you should never ever copy it. There are refcounted members
 //       in there.
 struct Q_QML_EXPORT Lookup {
+    // Number of internal classes a property lookup remembers before it becomes megamorphic
+    enum { PolymorphicEntries = 6 };
+
     enum class Call: quint16 {
         ContextGetterContextObjectMethod,
         ContextGetterContextObjectProperty,
@@ -66,6 +73,8 @@ struct Q_QML_EXPORT Lookup {
         GetterEnumValue,
         GetterGeneric,
         GetterIndexed,
+        GetterMegamorphic,
+        GetterPolymorphic,
         GetterProto,
         GetterProtoAccessor,
         GetterProtoAccessorTwoClasses,
@@ -126,6 +135,13 @@ struct Q_QML_EXPORT Lookup {
             const Value *data;
             const Value *data2;
         } protoLookupTwoClasses;
+        struct {
+            // Pairs of internal class and property index, unused pairs are undefined
+            HeapObjectWrapper<Heap::MemberData, 15> entries;
+            quintptr unused;
+            quintptr unused2;
+            quintptr unused3;
+        } objectLookupPolymorphic;
         struct {
             // Make sure the next two values are in sync with protoLookup
             quintptr protoId;
@@ -233,6 +249,8 @@ struct Q_QML_EXPORT Lookup {
     static ReturnedValue getter0Inlinegetter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getter0MemberDatagetter0MemberData(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterProtoTwoClasses(Lookup *lookup, ExecutionEngine *engine, const Value &object);
+    static ReturnedValue getterPolymorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object);
+    static ReturnedValue getterMegamorphic(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterAccessor(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterProtoAccessor(Lookup *lookup, ExecutionEngine *engine, const Value &object);
     static ReturnedValue getterProtoAccessorTwoClasses(Lookup *lookup, ExecutionEngine *engine, const Value &object);
@@ -353,6 +371,10 @@ struct Q_QML_EXPORT Lookup {
             return getterGeneric(this, engine, object);
         case Call::GetterIndexed:
             return getterIndexed(this, engine, object);
+        case Call::GetterMegamorphic:
+            return getterMegamorphic(this, engine, object);
+        case Call::GetterPolymorphic:
+            return getterPolymorphic(this, engine, object);
         case Call::GetterProto:
             return getterProto(this, engine, object);
         case Call::GetterProtoAccessor:
@@ -442,6 +464,77 @@ struct Q_QML_EXPORT Lookup {
 
 Q_STATIC_ASSERT(std::is_standard_layout<Lookup>::value);
 
+// Engine wide cache for property lookups that have seen too many internal classes to be
+// handled by the lookup itself. It maps (internal class, property key) to the index of an
+// own data property. Internal classes are not kept alive by the cache, so it has to be
+// cleared whenever the gc sweeps.
+struct MegamorphicLookupCache
+{
+    enum { Size = 512 };
+
+    struct Entry {
+        Heap::InternalClass *ic;
+        quint64 key;
+        uint index;
+    };
+
+    MegamorphicLookupCache() { clear(); }
+
+    void clear() { memset(entries, 0, sizeof(entries)); }
+
+    Entry &entry(const Heap::InternalClass *ic, PropertyKey key)
+    {
+        const quintptr hash = (reinterpret_cast<quintptr>(ic) >> 4) ^ quintptr(key.id() >> 3);
+        return entries[(hash ^ (hash >> 9)) % Size];
+    }
+
+    bool find(const Heap::InternalClass *ic, PropertyKey key, uint *index)
+    {
+        const Entry &e = entry(ic, key);
+        if (e.ic != ic || e.key != key.id())
+            return false;
+        *index = e.index;
+        return true;
+    }
+
+    void insert(Heap::InternalClass *ic, PropertyKey key, uint index)
+    {
+        Entry &e = entry(ic, key);
+        e.ic = ic;
+        e.key = key.id();
+        e.index = index;
+    }
+
+private:
+    Entry entries[Size];
+};
+
+// Collected when the qt.qml.lookup.statistics logging category is enabled at engine creation.
+// Counts how often lookups have to take a slow path, by kind of lookup and by source location.
+// Accesses through the megamorphic cache count as GetterMegamorphic, whether they hit or not.
+struct Q_QML_EXPORT LookupStatistics
+{
+    struct Site {
+        QString source;
+        QString name;
+        int line = -1;
+        Lookup::Call call = Lookup::Call::GetterGeneric;
+        quint64 slowPathCount = 0;
+    };
+
+    static bool isEnabled();
+    static const char *callName(Lookup::Call call);
+
+    void recordResolve(const Lookup *lookup, ExecutionEngine *engine);
+    void recordSlowPath(const Lookup *lookup, ExecutionEngine *engine);
+    QList<Site> sitesBySlowPathCount() const;
+    void dump() const;
+
+    QMap<Lookup::Call, quint64> slowPathCounts;
+    QHash<QString, Site> sites;
+    QSet<const Lookup *> resolvedLookups;
+};
+
 inline void setupQObjectLookup(
         Lookup *lookup, const QQmlData *ddata, const QQmlPropertyData *propertyData)
 {
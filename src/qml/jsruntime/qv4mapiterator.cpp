@@ -29,6 +29,7 @@ ReturnedValue MapIteratorPrototype::method_next(const FunctionObject *b, const V
 
     Scoped<MapObject> s(scope, thisObject->d()->iteratedMap);
     uint index = thisObject->d()->mapNextIndex;
+    quint64 sequenceNumber = thisObject->d()->mapNextSequenceNumber;
     IteratorKind itemKind = thisObject->d()->iterationKind;
 
     if (!s) {
@@ -38,9 +39,9 @@ ReturnedValue MapIteratorPrototype::method_next(const FunctionObject *b, const V
 
     Value *arguments = scope.alloc(2);
 
-    while (index < s->d()->esTable->size()) {
-        s->d()->esTable->iterate(index, &arguments[0], &arguments[1]);
+    while (s->d()->esTable->iterate(&index, &sequenceNumber, &arguments[0], &arguments[1])) {
         thisObject->d()->mapNextIndex = index + 1;
+        thisObject->d()->mapNextSequenceNumber = sequenceNumber + 1;
 
         ScopedValue result(scope);
 
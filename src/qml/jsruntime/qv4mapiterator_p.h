@@ -27,7 +27,8 @@ namespace Heap {
 #define MapIteratorObjectMembers(class, Member) \
     Member(class, Pointer, Object *, iteratedMap) \
     Member(class, NoMark, IteratorKind, iterationKind) \
-    Member(class, NoMark, quint32, mapNextIndex)
+    Member(class, NoMark, quint32, mapNextIndex) \
+    Member(class, NoMark, quint64, mapNextSequenceNumber)
 
 DECLARE_HEAP_OBJECT(MapIteratorObject, Object) {
     DECLARE_MARKOBJECTS(MapIteratorObject)
@@ -36,6 +37,7 @@ DECLARE_HEAP_OBJECT(MapIteratorObject, Object) {
         Object::init();
         this->iteratedMap.set(engine, obj);
         this->mapNextIndex = 0;
+        this->mapNextSequenceNumber = 0;
     }
 };
 
@@ -284,8 +284,7 @@ ReturnedValue MapPrototype::method_forEach(const FunctionObject *b, const Value
     ESTable::ShiftObserver observer{};
     that->d()->esTable->observeShifts(observer);
 
-    while (observer.pivot < that->d()->esTable->size()) {
-        that->d()->esTable->iterate(observer.pivot, &arguments[1], &arguments[0]); // fill in key (0), value (1)
+    while (that->d()->esTable->iterate(&observer.pivot, &arguments[1], &arguments[0])) { // fill in key (0), value (1)
 
         callbackfn->call(thisArg, arguments, 3);
         CHECK_EXCEPTION();
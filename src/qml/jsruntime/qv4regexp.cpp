@@ -38,29 +38,51 @@ RegExpCache::~RegExpCache()
     }
 }
 
+void RegExpCache::keepAlive(ExecutionEngine *engine, Heap::RegExp *regexp)
+{
+    for (Heap::RegExp *recent : recentlyCreated) {
+        if (recent == regexp)
+            return;
+    }
+
+    recentlyCreated[nextRecentlyCreated] = regexp;
+    nextRecentlyCreated = (nextRecentlyCreated + 1) % RecentlyCreatedSize;
+    QV4::WriteBarrier::markCustom(engine, [regexp](QV4::MarkStack *stack) {
+        regexp->mark(stack);
+    });
+}
+
+void RegExpCache::markObjects(MarkStack *markStack)
+{
+    for (Heap::RegExp *recent : recentlyCreated) {
+        if (recent)
+            recent->mark(markStack);
+    }
+}
+
 DEFINE_MANAGED_VTABLE(RegExp);
 
+// Skips the interpreter warm-up, so that the pattern is compiled with the JIT
+// the first time it is matched. Used for patterns that were compiled ahead of
+// time, which we expect to be used.
+void RegExp::jitOnFirstMatch()
+{
+#if ENABLE(YARR_JIT)
+    // QV4_FORCE_INTERPRETER disables the JIT by pushing the threshold out of reach.
+    const int threshold = ExecutionEngine::s_jitCallCountThreshold;
+    if (threshold != std::numeric_limits<int>::max())
+        d()->interpreterCallCount = std::max(d()->interpreterCallCount, threshold);
+#endif
+}
+
 uint RegExp::match(const QString &string, int start, uint *matchOffsets)
 {
     if (!isValid())
         return JSC::Yarr::offsetNoMatch;
 
-#if ENABLE(YARR_JIT)
     auto *priv = d();
 
-    auto regenerateByteCode = [](Heap::RegExp *regexp) {
-        JSC::Yarr::ErrorCode error = JSC::Yarr::ErrorCode::NoError;
-        JSC::Yarr::YarrPattern yarrPattern(WTF::String(*regexp->pattern), jscFlags(regexp->flags),
-                                           error);
-
-        // As we successfully parsed the pattern before, we should still be able to.
-        Q_ASSERT(error == JSC::Yarr::ErrorCode::NoError);
-
-        regexp->byteCode = JSC::Yarr::byteCompile(
-                                   yarrPattern,
-                                   regexp->internalClass->engine->bumperPointerAllocator).release();
-    };
-
+#if ENABLE(YARR_JIT)
     auto removeJitCode = [](Heap::RegExp *regexp) {
         delete regexp->jitCode;
         regexp->jitCode = nullptr;
@@ -91,10 +113,9 @@ uint RegExp::match(const QString &string, int start, uint *matchOffsets)
                 JSC::Yarr::jitCompile(yarrPattern, JSC::Yarr::Char16, vm, *priv->jitCode);
             }
 
-            if (!priv->hasValidJITCode()) {
+            // If this fails, the interpreter below compiles the byte code again.
+            if (!priv->hasValidJITCode())
                 removeJitCode(priv);
-                regenerateByteCode(priv);
-            }
         } else if (!longString) {
             // Short strings do the regular post-increment to honor
             // QV4_JIT_CALL_THRESHOLD.
@@ -123,11 +144,13 @@ uint RegExp::match(const QString &string, int start, uint *matchOffsets)
         removeJitCode(priv);
         // JIT failed. We need byteCode to run the interpreter.
         Q_ASSERT(!priv->byteCode);
-        regenerateByteCode(priv);
     }
 #endif // ENABLE(YARR_JIT)
 
-    return JSC::Yarr::interpret(byteCode(), s.characters16(), string.size(), start, matchOffsets);
+    if (!priv->byteCode && !priv->compileByteCode())
+        return JSC::Yarr::offsetNoMatch;
+
+    return JSC::Yarr::interpret(priv->byteCode, s.characters16(), string.size(), start, matchOffsets);
 }
 
 QString RegExp::getSubstitution(const QString &matched, const QString &str, int position, const Value *captures, int nCaptures, const QString &replacement)
@@ -193,15 +216,18 @@ Heap::RegExp *RegExp::create(
     if (!cache)
         cache = engine->regExpCache = new RegExpCache;
 
-    QV4::WeakValue &cachedValue = (*cache)[key];
-    if (QV4::RegExp *result = cachedValue.as<RegExp>())
-        return result->d();
+    const auto it = cache->constFind(key);
+    if (it != cache->cend()) {
+        if (QV4::RegExp *result = it->as<RegExp>())
+            return result->d();
+    }
 
     Scope scope(engine);
     Scoped<RegExp> result(scope, engine->memoryManager->alloc<RegExp>(engine, pattern, flags));
 
+    // The allocation may have swept dead RegExps, removing them from the cache.
     result->d()->cache = cache;
-    cachedValue.set(engine, result);
+    (*cache)[key].set(engine, result);
 
     return result->d();
 }
@@ -218,16 +244,35 @@ void Heap::RegExp::init(ExecutionEngine *engine, const QString &pattern, uint fl
         return;
     subPatternCount = yarrPattern.m_numSubpatterns;
     Q_UNUSED(engine);
-    byteCode = JSC::Yarr::byteCompile(yarrPattern, internalClass->engine->bumperPointerAllocator).release();
-    if (byteCode)
-        valid = true;
+
+    // The byte code is only generated once the interpreter needs it. Many
+    // patterns are never matched, or get compiled by the JIT right away.
+    valid = true;
+}
+
+bool Heap::RegExp::compileByteCode()
+{
+    JSC::Yarr::ErrorCode error = JSC::Yarr::ErrorCode::NoError;
+    JSC::Yarr::YarrPattern yarrPattern(WTF::String(*pattern), jscFlags(flags), error);
+
+    // As we successfully parsed the pattern before, we should still be able to.
+    Q_ASSERT(error == JSC::Yarr::ErrorCode::NoError);
+
+    byteCode = JSC::Yarr::byteCompile(
+                       yarrPattern, internalClass->engine->bumperPointerAllocator).release();
+    return byteCode;
 }
 
 void Heap::RegExp::destroy()
 {
     if (cache) {
-        RegExpCacheKey key(this);
-        cache->remove(key);
+        // We may be destroyed in an incremental sweep step, after the mutator
+        // already created a new RegExp for the same key. Leave that one alone.
+        const auto it = cache->constFind(RegExpCacheKey(this));
+        if (it != cache->cend()
+                && (it->isUndefined() || it->valueRef()->heapObject() == this)) {
+            cache->erase(it);
+        }
     }
 #if ENABLE(YARR_JIT)
     delete jitCode;
@@ -39,6 +39,7 @@ namespace Heap {
 struct RegExp : Base {
     void init(ExecutionEngine *engine, const QString& pattern, uint flags);
     void destroy();
+    bool compileByteCode();
 
     QString *pattern;
     JSC::Yarr::BytecodePattern *byteCode;
@@ -104,6 +105,7 @@ struct RegExp : public Managed
     bool isValid() const { return d()->valid; }
 
     uint match(const QString& string, int start, uint *matchOffsets);
+    void jitOnFirstMatch();
 
     int captureCount() const { return subPatternCount() + 1; }
 
@@ -140,6 +142,18 @@ class RegExpCache : public QHash<RegExpCacheKey, WeakValue>
 {
 public:
     ~RegExpCache();
+
+    void keepAlive(ExecutionEngine *engine, Heap::RegExp *regexp);
+    void markObjects(MarkStack *markStack);
+
+private:
+    // The cache only holds weak references. Patterns that are created from
+    // strings over and over again, e.g. "new RegExp(pattern)" in a validator,
+    // would lose their byte code and JIT code on every garbage collection.
+    // The most recently created ones are therefore kept alive.
+    enum { RecentlyCreatedSize = 32 };
+    Heap::RegExp *recentlyCreated[RecentlyCreatedSize] = {};
+    uint nextRecentlyCreated = 0;
 };
 
 
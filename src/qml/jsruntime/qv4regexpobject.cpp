@@ -99,7 +99,9 @@ void Heap::RegExpObject::init(const QRegularExpression &re)
     QString pattern = re.pattern();
     if (options & QRegularExpression::InvertedGreedinessOption)
         pattern = minimalPattern(pattern);
-    o->d()->value.set(scope.engine, QV4::RegExp::create(scope.engine, pattern, flags));
+    Heap::RegExp *regexp = QV4::RegExp::create(scope.engine, pattern, flags);
+    scope.engine->regExpCache->keepAlive(scope.engine, regexp);
+    o->d()->value.set(scope.engine, regexp);
     o->initProperties();
 }
 #endif
@@ -302,6 +304,7 @@ ReturnedValue RegExpCtor::virtualCallAsConstructor(const FunctionObject *fo, con
     if (!regexp->isValid()) {
         return scope.engine->throwSyntaxError(QStringLiteral("Invalid regular expression"));
     }
+    scope.engine->regExpCache->keepAlive(scope.engine, regexp->d());
 
     ReturnedValue o = Encode(scope.engine->newRegExpObject(regexp));
 
@@ -25,6 +25,7 @@
 #include <private/qv4scopedvalue_p.h>
 #include <private/qv4stackframe_p.h>
 #include <private/qv4symbol_p.h>
+#include <private/qv4typedarray_p.h>
 
 #include <wtf/MathExtras.h>
 
@@ -761,10 +762,41 @@ static Q_NEVER_INLINE ReturnedValue getElementFallback(ExecutionEngine *engine,
     return o->get(name);
 }
 
-ReturnedValue Runtime::LoadElement::call(ExecutionEngine *engine, const Value &object, const Value &index)
+// Typed arrays keep their elements in their buffer. Returns the typed array if
+// \a b is one, and \a idx is a valid index into it.
+static inline Heap::TypedArray *typedArrayElement(Heap::Base *b, uint idx)
+{
+    if (b->internalClass->vtable != TypedArray::staticVTable())
+        return nullptr;
+    Heap::TypedArray *a = static_cast<Heap::TypedArray *>(b);
+    if (quint64(idx) * a->type->bytesPerElement >= a->byteLength
+            || a->buffer->hasDetachedArrayData()) {
+        return nullptr;
+    }
+    return a;
+}
+
+// Numeric code often ends up with indices that are integral doubles
+static inline bool arrayIndexFromNumber(const Value &index, uint *idx)
 {
     if (index.isPositiveInt()) {
-        uint idx = static_cast<uint>(index.int_32());
+        *idx = static_cast<uint>(index.int_32());
+        return true;
+    }
+    if (index.isDouble()) {
+        const double d = index.doubleValue();
+        if (d >= 0 && d < double(std::numeric_limits<uint>::max())) {
+            *idx = static_cast<uint>(d);
+            return *idx == d;
+        }
+    }
+    return false;
+}
+
+ReturnedValue Runtime::LoadElement::call(ExecutionEngine *engine, const Value &object, const Value &index)
+{
+    uint idx;
+    if (arrayIndexFromNumber(index, &idx)) {
         if (Heap::Base *b = object.heapObject()) {
             if (b->internalClass->vtable->isObject) {
                 Heap::Object *o = static_cast<Heap::Object *>(b);
@@ -773,6 +805,9 @@ ReturnedValue Runtime::LoadElement::call(ExecutionEngine *engine, const Value &o
                     if (idx < s->values.size)
                         if (!s->data(idx).isEmpty())
                             return s->data(idx).asReturnedValue();
+                } else if (Heap::TypedArray *a = typedArrayElement(b, idx)) {
+                    return a->type->read(a->buffer->constArrayData() + a->byteOffset
+                                         + idx * a->type->bytesPerElement);
                 }
             }
         }
@@ -815,10 +850,41 @@ static Q_NEVER_INLINE bool setElementFallback(ExecutionEngine *engine, const Val
     return o->put(name, value);
 }
 
+// Whether we can append to the simple array data of an array without going through the
+// generic put: Nothing in the prototype chain may intercept indexed stores, and the array
+// itself has to be extensible, with a writable length that matches its array data.
+static bool canAppendToSimpleArray(const Heap::Object *o, const Heap::SimpleArrayData *s)
+{
+    if (o->internalClass->vtable->type != Managed::Type_ArrayObject
+            || s->attrs
+            || s->values.size >= s->values.alloc
+            || !o->internalClass->isExtensible()
+            || !o->internalClass->propertyData.at(Heap::ArrayObject::LengthPropertyIndex).isWritable()) {
+        return false;
+    }
+
+    const Value *length = o->propertyData(Heap::ArrayObject::LengthPropertyIndex);
+    if (!length->isInteger() || uint(length->integerValue()) != s->values.size)
+        return false;
+
+    // Exotic objects, like String objects, can expose indexed properties without array data.
+    const VTable *objectVTable = Object::staticVTable();
+    for (const Heap::Object *p = o->prototype(); p; p = p->prototype()) {
+        const VTable *vtable = p->internalClass->vtable;
+        if (p->arrayData
+                || vtable->put != objectVTable->put
+                || vtable->getOwnProperty != objectVTable->getOwnProperty
+                || vtable->defineOwnProperty != objectVTable->defineOwnProperty) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void Runtime::StoreElement::call(ExecutionEngine *engine, const Value &object, const Value &index, const Value &value)
 {
-    if (index.isPositiveInt()) {
-        uint idx = static_cast<uint>(index.int_32());
+    uint idx;
+    if (arrayIndexFromNumber(index, &idx)) {
         if (Heap::Base *b = object.heapObject()) {
             if (b->internalClass->vtable->isObject) {
                 Heap::Object *o = static_cast<Heap::Object *>(b);
@@ -828,6 +894,19 @@ void Runtime::StoreElement::call(ExecutionEngine *engine, const Value &object, c
                         s->setData(engine, idx, value);
                         return;
                     }
+                    if (idx == s->values.size && canAppendToSimpleArray(o, s)) {
+                        ++s->values.size;
+                        s->setData(engine, idx, value);
+                        o->setProperty(engine, Heap::ArrayObject::LengthPropertyIndex,
+                                       Value::fromUInt32(idx + 1));
+                        return;
+                    }
+                } else if (value.isNumber()) {
+                    if (Heap::TypedArray *a = typedArrayElement(b, idx)) {
+                        a->type->write(a->buffer->arrayData() + a->byteOffset
+                                       + idx * a->type->bytesPerElement, value);
+                        return;
+                    }
                 }
             }
         }
@@ -1872,16 +1951,28 @@ ReturnedValue Runtime::ObjectLiteral::call(ExecutionEngine *engine, int classId,
 {
     Scope scope(engine);
     Scoped<InternalClass> klass(scope, engine->currentStackFrame->v4Function->compilationUnit->runtimeClasses[classId]);
-    ScopedObject o(scope, engine->newObject(klass->d()));
 
     Q_ASSERT(uint(argc) >= klass->d()->size);
+    Q_ASSERT((argc - klass->d()->size) % 3 == 0);
+    int additionalArgs = (argc - int(klass->d()->size))/3;
+
+    // Members that aren't part of the precomputed class are defined one by one
+    // below. Leave room for them, so that the member data needn't grow.
+    uint capacity = klass->d()->size;
+    for (int i = 0; i < additionalArgs; ++i) {
+        const Value &type = args[klass->d()->size + 3 * i];
+        Q_ASSERT(type.isInteger());
+        const ObjectLiteralArgument arg = ObjectLiteralArgument(type.integerValue());
+        capacity += (arg == ObjectLiteralArgument::Getter || arg == ObjectLiteralArgument::Setter)
+                ? 2 : 1;
+    }
+
+    ScopedObject o(scope, engine->memoryManager->allocObjectWithCapacity<Object>(
+                              capacity, klass->d()));
 
     for (uint i = 0; i < klass->d()->size; ++i)
         o->setProperty(i, *args++);
 
-    Q_ASSERT((argc - klass->d()->size) % 3 == 0);
-    int additionalArgs = (argc - int(klass->d()->size))/3;
-
     if (!additionalArgs)
         return o->asReturnedValue();
 
@@ -29,6 +29,7 @@ ReturnedValue SetIteratorPrototype::method_next(const FunctionObject *b, const V
 
     Scoped<SetObject> s(scope, thisObject->d()->iteratedSet);
     uint index = thisObject->d()->setNextIndex;
+    quint64 sequenceNumber = thisObject->d()->setNextSequenceNumber;
     IteratorKind itemKind = thisObject->d()->iterationKind;
 
     if (!s) {
@@ -38,9 +39,9 @@ ReturnedValue SetIteratorPrototype::method_next(const FunctionObject *b, const V
 
     Value *arguments = scope.alloc(2);
 
-    while (index < s->d()->esTable->size()) {
-        s->d()->esTable->iterate(index, &arguments[0], &arguments[1]);
+    while (s->d()->esTable->iterate(&index, &sequenceNumber, &arguments[0], &arguments[1])) {
         thisObject->d()->setNextIndex = index + 1;
+        thisObject->d()->setNextSequenceNumber = sequenceNumber + 1;
 
         if (itemKind == KeyValueIteratorKind) {
             ScopedArrayObject resultArray(scope, scope.engine->newArrayObject());
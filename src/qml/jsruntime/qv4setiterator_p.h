@@ -27,7 +27,8 @@ namespace Heap {
 #define SetIteratorObjectMembers(class, Member) \
     Member(class, Pointer, Object *, iteratedSet) \
     Member(class, NoMark, IteratorKind, iterationKind) \
-    Member(class, NoMark, quint32, setNextIndex)
+    Member(class, NoMark, quint32, setNextIndex) \
+    Member(class, NoMark, quint64, setNextSequenceNumber)
 
 DECLARE_HEAP_OBJECT(SetIteratorObject, Object) {
     DECLARE_MARKOBJECTS(SetIteratorObject)
@@ -36,6 +37,7 @@ DECLARE_HEAP_OBJECT(SetIteratorObject, Object) {
         Object::init();
         this->iteratedSet.set(engine, obj);
         this->setNextIndex = 0;
+        this->setNextSequenceNumber = 0;
     }
 };
 
@@ -259,8 +259,7 @@ ReturnedValue SetPrototype::method_forEach(const FunctionObject *b, const Value
     that->d()->esTable->observeShifts(observer);
 
     Value *arguments = scope.alloc(3);
-    while (observer.pivot < that->d()->esTable->size()) {
-        that->d()->esTable->iterate(observer.pivot, &arguments[0], &arguments[1]); // fill in key (0), value (1)
+    while (that->d()->esTable->iterate(&observer.pivot, &arguments[0], &arguments[1])) { // fill in key (0), value (1)
         arguments[1] = arguments[0]; // but for set, we want to return the key twice; value is always undefined.
 
         arguments[2] = that;
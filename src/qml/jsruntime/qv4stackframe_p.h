@@ -47,6 +47,7 @@ struct Q_QML_EXPORT CppStackFrameBase
             const char *unwindHandler;
             const char *unwindLabel;
             int unwindLevel;
+            int onStackReplacementOffset;
             bool yieldIsIterator;
             bool callerCanHandleTailCall;
             bool pendingTailCall;
@@ -169,6 +170,7 @@ struct Q_QML_EXPORT JSTypesStackFrame : public CppStackFrame
     using CppStackFrame::unwindHandler;
     using CppStackFrame::unwindLabel;
     using CppStackFrame::unwindLevel;
+    using CppStackFrame::onStackReplacementOffset;
 
     void init(Function *v4Function, const Value *argv, int argc,
               bool callerCanHandleTailCall = false)
@@ -183,6 +185,7 @@ struct Q_QML_EXPORT JSTypesStackFrame : public CppStackFrame
         CppStackFrame::isTailCalling = false;
         CppStackFrame::unwindLabel = nullptr;
         CppStackFrame::unwindLevel = 0;
+        CppStackFrame::onStackReplacementOffset = -1;
     }
 
     const Value *argv() const { return originalArguments; }
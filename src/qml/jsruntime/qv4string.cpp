@@ -11,6 +11,9 @@
 
 using namespace QV4;
 
+// Flattened strings at least this long get room for appending more text.
+static const int MinimumAppendableLength = 256;
+
 void Heap::StringOrSymbol::markObjects(Heap::Base *that, MarkStack *markStack)
 {
     StringOrSymbol *s = static_cast<StringOrSymbol *>(that);
@@ -32,6 +35,9 @@ void Heap::String::markObjects(Heap::Base *that, MarkStack *markStack)
         cs->right->mark(markStack);
     } else {
         Q_ASSERT(cs->subtype == StringType_SubString);
+        // Skip former owners of an appendable buffer, so that an early prefix
+        // doesn't keep all the strings that were appended to it alive.
+        cs->left = cs->substringBase();
         cs->left->mark(markStack);
     }
 }
@@ -67,11 +73,16 @@ void Heap::ComplexString::init(String *l, String *r)
     left = l;
     right = r;
     len = left->length() + right->length();
-    if (left->subtype >= StringType_Complex)
+
+    if (left == internalClass->engine->appendableString && appendInPlace())
+        return;
+
+    // Substrings reuse the largestSubLength field for their offset.
+    if (left->subtype == StringType_AddedString)
         largestSubLength = static_cast<ComplexString *>(left)->largestSubLength;
     else
         largestSubLength = left->length();
-    if (right->subtype >= StringType_Complex)
+    if (right->subtype == StringType_AddedString)
         largestSubLength = qMax(largestSubLength, static_cast<ComplexString *>(right)->largestSubLength);
     else
         largestSubLength = qMax(largestSubLength, right->length());
@@ -86,6 +97,17 @@ void Heap::ComplexString::init(Heap::String *ref, int from, int len)
     Q_ASSERT(ref->length() >= from + len);
     StringOrSymbol::init();
 
+    // Never refer to a concatenation, so that flattening a substring never has
+    // to recurse into another flattening.
+    if (ref->subtype == StringType_AddedString)
+        ref->simplifyString();
+    while (ref->subtype == StringType_SubString) {
+        const ComplexString *cs = static_cast<const ComplexString *>(ref);
+        from += cs->from;
+        ref = cs->left;
+    }
+    Q_ASSERT(ref->subtype < StringType_Complex);
+
     subtype = String::StringType_SubString;
 
     left = ref;
@@ -134,17 +156,112 @@ void Heap::String::simplifyString() const
     Q_ASSERT(subtype >= StringType_AddedString);
 
     int l = length();
-    QString result(l, Qt::Uninitialized);
+    const ComplexString *cs = static_cast<const ComplexString *>(this);
+
+    // A long string with a short piece added to the end is most likely being
+    // built piece by piece. Leave room behind it, so that the following pieces
+    // can be appended in place, see ComplexString::appendInPlace().
+    const bool appendable = subtype == StringType_AddedString
+            && l >= MinimumAppendableLength && cs->right->length() <= l / 4;
+
+    QString result;
+    if (appendable) {
+        result.reserve(2 * l);
+        result.resize(l);
+    } else {
+        result = QString(l, Qt::Uninitialized);
+    }
     QChar *ch = const_cast<QChar *>(result.constData());
     append(this, ch);
     text() = result.data_ptr();
-    const ComplexString *cs = static_cast<const ComplexString *>(this);
     identifier = PropertyKey::invalid();
     cs->left = cs->right = nullptr;
 
     internalClass->engine->memoryManager->changeUnmanagedHeapSizeUsage(
                 qptrdiff(text().size) * qptrdiff(sizeof(QChar)));
     subtype = StringType_Unknown;
+
+    if (appendable)
+        internalClass->engine->setAppendableString(const_cast<String *>(this));
+}
+
+/*
+    Called when concatenating to the engine's appendable string. If its text
+    buffer has enough room left, the right side is copied right behind it and
+    this string becomes flat, taking over the buffer and the room left behind
+    it. The previous owner of the buffer turns into a substring of this one, so
+    that the buffer is accounted for only once. Buffers that are shared with
+    anyone else, and the ones of identifiers, are left alone.
+
+    Former owners can only refer to a later one, so a chain of them builds up
+    if they are kept alive. The garbage collector shortcuts such chains, see
+    markObjects(). Each chain is bounded by its buffer, though: A full buffer
+    is never grown in place. The next flattening copies the text instead.
+*/
+bool Heap::ComplexString::appendInPlace()
+{
+    Q_ASSERT(left->subtype < StringType_Complex);
+
+    ComplexString *previous = static_cast<ComplexString *>(left);
+    QStringPrivate &buffer = left->text();
+
+    // Anyone else sharing the buffer, like a QString handed out by
+    // toQString(), relies on the null character behind the text. Identifiers
+    // have to stay flat, so they can't give their buffer away.
+    if (buffer.isShared() || previous->identifier.isValid())
+        return false;
+
+    const int rightLength = right->length();
+    // Keep room for the terminating null character.
+    if (buffer.freeSpaceAtEnd() <= rightLength)
+        return false;
+
+    ExecutionEngine *engine = internalClass->engine;
+
+    QStringPrivate result = buffer;
+    QChar *ch = reinterpret_cast<QChar *>(result.data() + result.size);
+    append(right, ch);
+    ch[rightLength] = u'\0';
+    result.size = len;
+
+    text() = std::move(result);
+    engine->memoryManager->changeUnmanagedHeapSizeUsage(
+                qptrdiff(text().size) * qptrdiff(sizeof(QChar)));
+    left = right = nullptr;
+    subtype = StringType_Unknown;
+    engine->setAppendableString(this);
+
+    const int previousLength = int(buffer.size);
+    engine->memoryManager->changeUnmanagedHeapSizeUsage(
+                -qptrdiff(previousLength) * qptrdiff(sizeof(QChar)));
+    buffer = QStringPrivate();
+    previous->subtype = StringType_SubString;
+    previous->left = this;
+    previous->from = 0;
+    previous->len = previousLength;
+    QV4::WriteBarrier::markCustom(engine, [this](QV4::MarkStack *stack) {
+        mark(stack);
+    });
+    return true;
+}
+
+/*
+    Returns the flat string this substring refers to. That is only different
+    from left if left gave its buffer away in appendInPlace() after this
+    substring was created. Former owners always start at offset 0 of the
+    string that took over the buffer.
+*/
+Heap::String *Heap::ComplexString::substringBase() const
+{
+    Q_ASSERT(subtype == StringType_SubString);
+    String *base = left;
+    while (base->subtype == StringType_SubString) {
+        const ComplexString *cs = static_cast<const ComplexString *>(base);
+        Q_ASSERT(cs->from == 0);
+        base = cs->left;
+    }
+    Q_ASSERT(base->subtype < StringType_Complex);
+    return base;
 }
 
 bool Heap::String::startsWithUpper() const
@@ -158,10 +275,7 @@ bool Heap::String::startsWithUpper() const
         const ComplexString *cs = static_cast<const Heap::ComplexString *>(this);
         if (!cs->len)
             return false;
-        // simplification here is not ideal, but hopefully not a common case.
-        if (cs->left->subtype >= Heap::String::StringType_Complex)
-            cs->left->simplifyString();
-        str = cs->left;
+        str = cs->substringBase();
         offset = cs->from;
     }
     Q_ASSERT(str->subtype < Heap::String::StringType_Complex);
@@ -198,7 +312,8 @@ void Heap::String::append(const String *data, QChar *ch)
         } else if (item->subtype == StringType_SubString) {
             worklist.pop_back();
             const ComplexString *cs = static_cast<const ComplexString *>(item.data());
-            memcpy(ch, cs->left->toQString().constData() + cs->from, cs->len*sizeof(QChar));
+            const String *flat = cs->substringBase();
+            memcpy(static_cast<void *>(ch), flat->text().data() + cs->from, cs->len * sizeof(QChar));
             ch += cs->len;
         } else {
             worklist.pop_back();
@@ -110,7 +110,7 @@ struct Q_QML_EXPORT String : StringOrSymbol {
 
     bool startsWithUpper() const;
 
-private:
+protected:
     static void append(const String *data, QChar *ch);
 };
 Q_STATIC_ASSERT(std::is_trivial_v<String>);
@@ -118,6 +118,8 @@ Q_STATIC_ASSERT(std::is_trivial_v<String>);
 struct ComplexString : String {
     void init(String *l, String *n);
     void init(String *ref, int from, int len);
+    bool appendInPlace();
+    String *substringBase() const;
     mutable String *left;
     mutable String *right;
     union {
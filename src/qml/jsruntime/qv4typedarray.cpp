@@ -173,9 +173,9 @@ ReturnedValue atomicCompareExchange(char *data, Value expected, Value v)
 }
 
 template <typename T>
-ReturnedValue atomicLoad(char *data)
+ReturnedValue atomicLoad(const char *data)
 {
-    typename QAtomicOps<T>::Type *mem = reinterpret_cast<typename QAtomicOps<T>::Type *>(data);
+    const typename QAtomicOps<T>::Type *mem = reinterpret_cast<const typename QAtomicOps<T>::Type *>(data);
     T val = QAtomicOps<T>::loadRelaxed(*mem);
     return typeToValue(val);
 }
@@ -189,6 +189,119 @@ ReturnedValue atomicStore(char *data, Value v)
     return typeToValue(value);
 }
 
+// The bulk operations below work on the elements in their native
+// representation, rather than converting each of them to a Value.
+
+template <typename T>
+struct Element { using Type = T; };
+template <>
+struct Element<ClampedUInt8> { using Type = quint8; };
+
+template <typename T>
+void fill(char *data, uint length, Value value)
+{
+    std::fill_n(reinterpret_cast<T *>(data), length, valueToType<T>(value));
+}
+
+// Converts \a d to an element of type \a E, if it can be represented exactly.
+// Otherwise, no element can be equal to it.
+template <typename E>
+bool elementFromDouble(double d, E *e)
+{
+    if constexpr (std::is_integral_v<E>) {
+        if (!(d >= double(std::numeric_limits<E>::min())
+              && d <= double(std::numeric_limits<E>::max()))) {
+            return false;
+        }
+    } else if constexpr (std::is_same_v<E, float>) {
+        // Converting finite doubles out of the range of float is undefined.
+        if (std::isfinite(d) && std::abs(d) > double(std::numeric_limits<float>::max()))
+            return false;
+    }
+    *e = static_cast<E>(d);
+    return double(*e) == d;
+}
+
+// Returns the index of the first element in [from, to) that is strictly equal
+// to \a value, or the same value as \a value in the sense of SameValueZero if
+// \a sameValueZero is set. Returns -1 if there is no such element.
+template <typename T>
+qint64 indexOf(const char *data, uint from, uint to, Value value, bool sameValueZero)
+{
+    using E = typename Element<T>::Type;
+    const E *elements = reinterpret_cast<const E *>(data);
+    if (!value.isNumber())
+        return -1;
+
+    const double d = value.asDouble();
+    if (std::isnan(d)) {
+        if constexpr (std::is_floating_point_v<E>) {
+            if (sameValueZero) {
+                const E *it = std::find_if(elements + from, elements + to,
+                                           [](E e) { return std::isnan(e); });
+                if (it != elements + to)
+                    return it - elements;
+            }
+        }
+        return -1;
+    }
+
+    E e;
+    if (!elementFromDouble(d, &e))
+        return -1;
+    const E *it = std::find(elements + from, elements + to, e);
+    return it == elements + to ? -1 : it - elements;
+}
+
+// Like indexOf, but returns the last matching element in [from, to).
+template <typename T>
+qint64 lastIndexOf(const char *data, uint from, uint to, Value value, bool sameValueZero)
+{
+    using E = typename Element<T>::Type;
+    const E *elements = reinterpret_cast<const E *>(data);
+    if (!value.isNumber())
+        return -1;
+
+    const double d = value.asDouble();
+    if (std::isnan(d)) {
+        if constexpr (std::is_floating_point_v<E>) {
+            if (sameValueZero) {
+                for (uint i = to; i > from; --i) {
+                    if (std::isnan(elements[i - 1]))
+                        return i - 1;
+                }
+            }
+        }
+        return -1;
+    }
+
+    E e;
+    if (!elementFromDouble(d, &e))
+        return -1;
+    for (uint i = to; i > from; --i) {
+        if (elements[i - 1] == e)
+            return i - 1;
+    }
+    return -1;
+}
+
+// Sorts numerically, as required for TypedArray.prototype.sort without a
+// comparison function: NaN goes to the end, and -0 before +0.
+template <typename T>
+void sort(char *data, uint length)
+{
+    using E = typename Element<T>::Type;
+    E *elements = reinterpret_cast<E *>(data);
+    if constexpr (std::is_floating_point_v<E>) {
+        E *end = std::partition(elements, elements + length, [](E e) { return !std::isnan(e); });
+        std::sort(elements, end, [](E a, E b) {
+            return a < b || (a == b && std::signbit(a) && !std::signbit(b));
+        });
+    } else {
+        std::sort(elements, elements + length);
+    }
+}
+
 
 template<typename T>
 constexpr TypedArrayOperations TypedArrayOperations::create(const char *name)
@@ -200,7 +313,11 @@ constexpr TypedArrayOperations TypedArrayOperations::create(const char *name)
              { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
              nullptr,
              nullptr,
-             nullptr
+             nullptr,
+             ::fill<T>,
+             ::indexOf<T>,
+             ::lastIndexOf<T>,
+             ::sort<T>
     };
 }
 
@@ -214,7 +331,11 @@ constexpr TypedArrayOperations TypedArrayOperations::createWithAtomics(const cha
              { ::atomicAdd<T>, ::atomicAnd<T>, ::atomicExchange<T>, ::atomicOr<T>, ::atomicSub<T>, ::atomicXor<T> },
              ::atomicCompareExchange<T>,
              ::atomicLoad<T>,
-             ::atomicStore<T>
+             ::atomicStore<T>,
+             ::fill<T>,
+             ::indexOf<T>,
+             ::lastIndexOf<T>,
+             ::sort<T>
     };
 }
 
@@ -713,7 +834,6 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_every(const FunctionObject *b
     ScopedValue r(scope);
     Value *arguments = scope.alloc(3);
 
-    const char *data = v->constArrayData();
     uint bytesPerElement = v->bytesPerElement();
     uint byteOffset = v->byteOffset();
 
@@ -722,7 +842,8 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_every(const FunctionObject *b
         if (v->hasDetachedArrayData())
             return scope.engine->throwTypeError();
 
-        arguments[0] = v->d()->type->read(data + byteOffset + k * bytesPerElement);
+        // The callback may write to the array, which moves external data.
+        arguments[0] = v->d()->type->read(v->constArrayData() + byteOffset + k * bytesPerElement);
 
         arguments[1] = Value::fromDouble(k);
         arguments[2] = v;
@@ -765,7 +886,6 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_fill(const FunctionObject *b,
     if (scope.hasException() || v->hasDetachedArrayData())
         return scope.engine->throwTypeError();
 
-    char *data = v->arrayData();
     uint bytesPerElement = v->bytesPerElement();
     uint byteOffset = v->byteOffset();
 
@@ -777,10 +897,8 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_fill(const FunctionObject *b,
     else
         value.setDouble(argv[0].toNumber());
 
-    while (k < fin) {
-        v->d()->type->write(data + byteOffset + k * bytesPerElement, value);
-        k++;
-    }
+    if (k < fin)
+        v->d()->type->fill(v->arrayData() + byteOffset + k * bytesPerElement, fin - k, value);
 
     return v.asReturnedValue();
 }
@@ -982,15 +1100,15 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_includes(const FunctionObject
         }
     }
 
-    while (k < len) {
-        ScopedValue val(scope, v->get(k));
-        if (val->sameValueZero(argv[0])) {
-            return Encode(true);
-        }
-        k++;
-    }
+    if (k >= len)
+        return Encode(false);
+    if (v->hasDetachedArrayData())
+        return scope.engine->throwTypeError();
 
-    return Encode(false);
+    const qint64 index = v->d()->type->indexOf(
+            v->constArrayData() + v->byteOffset(), uint(k), len,
+            argc ? argv[0] : Value::undefinedValue(), true);
+    return Encode(index >= 0);
 }
 
 ReturnedValue IntrinsicTypedArrayPrototype::method_indexOf(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
@@ -1017,27 +1135,12 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_indexOf(const FunctionObject
         fromIndex = (uint) f;
     }
 
-    if (v->isStringObject()) {
-        ScopedValue value(scope);
-        for (uint k = fromIndex; k < len; ++k) {
-            bool exists;
-            value = v->get(k, &exists);
-            if (exists && RuntimeHelpers::strictEqual(value, searchValue))
-                return Encode(k);
-        }
-        return Encode(-1);
-    }
-
-    ScopedValue value(scope);
+    if (v->hasDetachedArrayData())
+        return scope.engine->throwTypeError();
 
-    for (uint i = fromIndex; i < len; ++i) {
-        bool exists;
-        value = v->get(i, &exists);
-        CHECK_EXCEPTION();
-        if (exists && RuntimeHelpers::strictEqual(value, searchValue))
-            return Encode(i);
-    }
-    return Encode(-1);
+    const qint64 index = v->d()->type->indexOf(
+            v->constArrayData() + v->byteOffset(), fromIndex, len, *searchValue, false);
+    return index < 0 ? Encode(-1) : Encode(uint(index));
 }
 
 ReturnedValue IntrinsicTypedArrayPrototype::method_join(
@@ -1125,15 +1228,12 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_lastIndexOf(const FunctionObj
         fromIndex = (uint) f + 1;
     }
 
-    ScopedValue value(scope);
-    for (uint k = fromIndex; k > 0;) {
-        --k;
-        bool exists;
-        value = instance->get(k, &exists);
-        if (exists && RuntimeHelpers::strictEqual(value, searchValue))
-            return Encode(k);
-    }
-    return Encode(-1);
+    if (instance->hasDetachedArrayData())
+        return scope.engine->throwTypeError();
+
+    const qint64 index = instance->d()->type->lastIndexOf(
+            instance->constArrayData() + instance->byteOffset(), 0, fromIndex, *searchValue, false);
+    return index < 0 ? Encode(-1) : Encode(uint(index));
 }
 
 ReturnedValue IntrinsicTypedArrayPrototype::method_map(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
@@ -1341,6 +1441,63 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_some(const FunctionObject *b,
     return Encode(false);
 }
 
+ReturnedValue IntrinsicTypedArrayPrototype::method_sort(const FunctionObject *b, const Value *thisObject, const Value *argv, int argc)
+{
+    Scope scope(b);
+    const bool hasComparefn = argc && !argv[0].isUndefined();
+    if (hasComparefn && !argv[0].isFunctionObject())
+        THROW_TYPE_ERROR();
+
+    Scoped<TypedArray> instance(scope, thisObject);
+    if (!instance || instance->hasDetachedArrayData())
+        return scope.engine->throwTypeError();
+
+    const uint len = instance->length();
+    if (len < 2)
+        return instance->asReturnedValue();
+
+    if (!hasComparefn) {
+        instance->d()->type->sort(instance->arrayData() + instance->byteOffset(), len);
+        return instance->asReturnedValue();
+    }
+
+    // The comparison function may do anything, including modifying the array.
+    // Sort a copy of the elements and write them back afterwards.
+    std::vector<Value> elements(len);
+    const TypedArrayOperations::Read read = instance->d()->type->read;
+    const char *data = instance->constArrayData() + instance->byteOffset();
+    const int elementSize = instance->bytesPerElement();
+    for (uint i = 0; i < len; ++i)
+        elements[i] = Value::fromReturnedValue(read(data + i * elementSize));
+
+    const FunctionObject *comparefn = static_cast<const FunctionObject *>(argv);
+    ScopedValue that(scope, Value::undefinedValue());
+    ScopedValue result(scope);
+    Value *arguments = scope.alloc(2);
+    std::stable_sort(elements.begin(), elements.end(), [&](Value x, Value y) {
+        if (scope.hasException())
+            return false;
+        arguments[0] = x;
+        arguments[1] = y;
+        result = comparefn->call(that, arguments, 2);
+        if (scope.hasException())
+            return false;
+        const double v = result->toNumber();
+        if (instance->hasDetachedArrayData()) {
+            scope.engine->throwTypeError();
+            return false;
+        }
+        return v < 0;
+    });
+    CHECK_EXCEPTION();
+
+    char *dest = instance->arrayData() + instance->byteOffset();
+    const TypedArrayOperations::Write write = instance->d()->type->write;
+    for (uint i = 0; i < len; ++i)
+        write(dest + i * elementSize, elements[i]);
+    return instance->asReturnedValue();
+}
+
 
 ReturnedValue IntrinsicTypedArrayPrototype::method_values(const FunctionObject *b, const Value *thisObject, const Value *, int)
 {
@@ -1486,6 +1643,20 @@ ReturnedValue IntrinsicTypedArrayPrototype::method_slice(const FunctionObject *b
     if (!a)
         return Encode::undefined();
 
+    // Same element type, copy the bytes. A species constructor may hand us an
+    // array sharing the buffer. The spec copies front to back then, which is
+    // what the element by element copy below does.
+    if (count && a->d()->type == instance->d()->type
+            && a->d()->buffer.get() != instance->d()->buffer.get()) {
+        if (instance->hasDetachedArrayData() || a->hasDetachedArrayData())
+            return scope.engine->throwTypeError();
+        const int elementSize = instance->bytesPerElement();
+        char *dest = a->arrayData() + a->byteOffset();
+        memcpy(dest, instance->constArrayData() + instance->byteOffset() + start * elementSize,
+               count * elementSize);
+        return a->asReturnedValue();
+    }
+
     ScopedValue v(scope);
     uint n = 0;
     for (uint i = start; i < end; ++i) {
@@ -1822,6 +1993,7 @@ void IntrinsicTypedArrayPrototype::init(ExecutionEngine *engine, IntrinsicTypedA
     defineDefaultProperty(QStringLiteral("reduceRight"), method_reduceRight, 1);
     defineDefaultProperty(QStringLiteral("reverse"), method_reverse, 0);
     defineDefaultProperty(QStringLiteral("some"), method_some, 1);
+    defineDefaultProperty(QStringLiteral("sort"), method_sort, 1);
     defineDefaultProperty(QStringLiteral("set"), method_set, 1);
     defineDefaultProperty(QStringLiteral("slice"), method_slice, 2);
     defineDefaultProperty(QStringLiteral("subarray"), method_subarray, 2);
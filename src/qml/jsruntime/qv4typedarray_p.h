@@ -52,8 +52,11 @@ struct TypedArrayOperations {
     typedef void (*Write)(char *data, Value value);
     typedef ReturnedValue (*AtomicModify)(char *data, Value value);
     typedef ReturnedValue (*AtomicCompareExchange)(char *data, Value expected, Value v);
-    typedef ReturnedValue (*AtomicLoad)(char *data);
+    typedef ReturnedValue (*AtomicLoad)(const char *data);
     typedef ReturnedValue (*AtomicStore)(char *data, Value value);
+    typedef void (*Fill)(char *data, uint length, Value value);
+    typedef qint64 (*Find)(const char *data, uint from, uint to, Value value, bool sameValueZero);
+    typedef void (*Sort)(char *data, uint length);
 
     template<typename T>
     static constexpr TypedArrayOperations create(const char *name);
@@ -68,6 +71,10 @@ struct TypedArrayOperations {
     AtomicCompareExchange atomicCompareExchange;
     AtomicLoad atomicLoad;
     AtomicStore atomicStore;
+    Fill fill;
+    Find indexOf;
+    Find lastIndexOf;
+    Sort sort;
 };
 
 namespace Heap {
@@ -117,7 +124,7 @@ struct Q_QML_EXPORT TypedArray : Object
     int bytesPerElement() const noexcept { return d()->type->bytesPerElement; }
     uint length() const noexcept  { return d()->byteLength / d()->type->bytesPerElement; }
 
-    char *arrayData() noexcept { return d()->buffer->arrayData(); }
+    char *arrayData() { return d()->buffer->arrayData(); }
     const char *constArrayData() const noexcept { return d()->buffer->constArrayData(); }
     bool hasDetachedArrayData() const noexcept { return d()->buffer->hasDetachedArrayData(); }
     uint arrayDataLength() const noexcept { return d()->buffer->arrayDataLength(); }
@@ -183,6 +190,7 @@ struct IntrinsicTypedArrayPrototype : Object
     static ReturnedValue method_reduceRight(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
     static ReturnedValue method_reverse(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
     static ReturnedValue method_some(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
+    static ReturnedValue method_sort(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
     static ReturnedValue method_values(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
     static ReturnedValue method_set(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
     static ReturnedValue method_slice(const FunctionObject *, const Value *thisObject, const Value *argv, int argc);
@@ -26,6 +26,7 @@
 #include <private/qv4qmlcontext_p.h>
 #include <QtQml/private/qv4runtime_p.h>
 #include <iostream>
+#include <algorithm>
 
 #if QT_CONFIG(qml_jit)
 #include <private/qv4baselinejit_p.h>
@@ -39,6 +40,7 @@ Q_TRACE_POINT(qtqml, QQmlV4_function_call_entry, const QV4::ExecutionEngine *eng
 Q_TRACE_POINT(qtqml, QQmlV4_function_call_exit)
 
 enum { ShowWhenDeoptimiationHappens = 0 };
+enum { BackEdgesPerCall = 1000 };
 
 extern "C" {
 
@@ -374,6 +376,54 @@ static bool compareEqualInt(QV4::Value &accumulator, QV4::Value lhs, int rhs)
     }
 }
 
+#if QT_CONFIG(qml_jit)
+/*
+    Called for every BackEdgesPerCall loop iterations a function runs in the
+    interpreter. Each of those counts as one call towards the JIT threshold.
+    Once the function is jitted, the rest of it runs as jitted code, starting
+    at the beginning of the loop. Returns false if it has to stay interpreted.
+ */
+static bool onStackReplacement(JSTypesStackFrame *frame, ExecutionEngine *engine,
+                               const char *loopStart, ReturnedValue acc, ReturnedValue *result)
+{
+    Function *function = frame->v4Function;
+
+    // the jitted code doesn't know about the exception handler set up by the interpreter
+    if (engine->debugger() || frame->unwindHandler)
+        return false;
+
+    if (function->codeRef == nullptr) {
+        ++function->interpreterCallCount;
+        if (!engine->canJIT(function))
+            return false;
+        QV4::JIT::BaselineJIT(function).generate();
+    }
+    if (function->jittedCode == nullptr)
+        return false;
+
+    const int offset = int(loopStart - function->codeData);
+    const quint32_le *loopStarts = function->compiledFunction->labelInfoTable();
+    const quint32_le *loopStartsEnd = loopStarts + function->compiledFunction->nLabelInfos;
+    if (std::find(loopStarts, loopStartsEnd, quint32(offset)) == loopStartsEnd)
+        return false;
+
+    frame->jsFrame->accumulator = acc;
+    frame->onStackReplacementOffset = offset;
+    *result = function->jittedCode(frame, engine);
+    return true;
+}
+
+#define CHECK_BACK_EDGE \
+    if (offset < 0 && Q_UNLIKELY(++function->interpreterBackEdgeCount == BackEdgesPerCall)) { \
+        function->interpreterBackEdgeCount = 0; \
+        ReturnedValue jittedResult; \
+        if (onStackReplacement(frame, engine, code, acc, &jittedResult)) \
+            return jittedResult; \
+    }
+#else
+#define CHECK_BACK_EDGE
+#endif
+
 #define STORE_IP() frame->instructionPointer = int(code - function->codeData);
 #define STORE_ACC() accumulator = acc;
 #define ACC Value::fromReturnedValue(acc)
@@ -1047,6 +1097,7 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
 
     MOTH_BEGIN_INSTR(Jump)
         code += offset;
+        CHECK_BACK_EDGE
     MOTH_END_INSTR(Jump)
 
     MOTH_BEGIN_INSTR(JumpTrue)
@@ -1055,8 +1106,10 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
             takeJump = ACC.int_32();
         else
             takeJump = ACC.toBoolean();
-        if (takeJump)
+        if (takeJump) {
             code += offset;
+            CHECK_BACK_EDGE
+        }
     MOTH_END_INSTR(JumpTrue)
 
     MOTH_BEGIN_INSTR(JumpFalse)
@@ -1065,8 +1118,10 @@ QV4::ReturnedValue VME::interpret(JSTypesStackFrame *frame, ExecutionEngine *eng
             takeJump = !ACC.int_32();
         else
             takeJump = !ACC.toBoolean();
-        if (takeJump)
+        if (takeJump) {
             code += offset;
+            CHECK_BACK_EDGE
+        }
     MOTH_END_INSTR(JumpFalse)
 
     MOTH_BEGIN_INSTR(JumpNoException)
@@ -6,6 +6,7 @@
 #include "qv4mm_p.h"
 #include "qv4qobjectwrapper_p.h"
 #include "qv4identifiertable_p.h"
+#include "qv4lookup_p.h"
 #include <QtCore/qalgorithms.h>
 #include <QtCore/private/qnumeric_p.h>
 #include <QtCore/qloggingcategory.h>
@@ -17,6 +18,7 @@
 #include <QElapsedTimer>
 #include <QMap>
 #include <QScopedValueRollback>
+#include <QTimer>
 
 #include <cstdlib>
 #include <algorithm>
@@ -55,6 +57,11 @@
 #include <pthread_np.h>
 #endif
 
+#include <qtqml_tracepoints_p.h>
+
+Q_TRACE_POINT(qtqml, QQmlV4_gc_step_entry, const QV4::ExecutionEngine *engine, int state, qint64 timeLimitUs)
+Q_TRACE_POINT(qtqml, QQmlV4_gc_step_exit)
+
 Q_STATIC_LOGGING_CATEGORY(lcGcStats, "qt.qml.gc.statistics")
 Q_STATIC_LOGGING_CATEGORY(lcGcAllocatorStats, "qt.qml.gc.allocatorStats")
 Q_STATIC_LOGGING_CATEGORY(lcGcStateTransitions, "qt.qml.gc.stateTransitions")
@@ -102,6 +109,14 @@ struct MemorySegment {
         qSwap(availableBytes, other.availableBytes);
         qSwap(nChunks, other.nChunks);
     }
+    MemorySegment &operator=(MemorySegment &&other) {
+        qSwap(pageReservation, other.pageReservation);
+        qSwap(base, other.base);
+        qSwap(allocatedMap, other.allocatedMap);
+        qSwap(availableBytes, other.availableBytes);
+        qSwap(nChunks, other.nChunks);
+        return *this;
+    }
 
     ~MemorySegment() {
         if (base)
@@ -232,9 +247,22 @@ Chunk *ChunkAllocator::allocate(size_t size)
 void ChunkAllocator::free(Chunk *chunk, size_t size)
 {
     size = requiredChunkSize(size);
-    for (auto &m : memorySegments) {
-        if (m.contains(chunk)) {
-            m.free(chunk, size);
+    for (auto it = memorySegments.begin(); it != memorySegments.end(); ++it) {
+        if (it->contains(chunk)) {
+            it->free(chunk, size);
+            // All chunks of the segment are decommitted by now. Also release the address
+            // space, unless it's the only empty segment. Keeping one around avoids mapping
+            // and unmapping memory in every gc cycle of a heap whose size goes back and
+            // forth across a segment boundary.
+            if (!it->allocatedMap) {
+                const bool hasOtherEmptySegment = std::any_of(
+                        memorySegments.cbegin(), memorySegments.cend(),
+                        [&](const MemorySegment &segment) {
+                    return &segment != &*it && !segment.allocatedMap;
+                });
+                if (hasOtherEmptySegment)
+                    memorySegments.erase(it);
+            }
             return;
         }
     }
@@ -453,6 +481,9 @@ HeapItem *BlockAllocator::allocate(size_t size, bool forceAllocation) {
 
     HeapItem *m;
 
+    bool sweptBeforeGrowing = false;
+
+retry:
     if (slotsRequired < NumBins - 1) {
         m = freeBins[slotsRequired];
         if (m) {
@@ -524,6 +555,21 @@ HeapItem *BlockAllocator::allocate(size_t size, bool forceAllocation) {
     if (!m) {
         if (!forceAllocation)
             return nullptr;
+
+        // While the chunks are swept incrementally, only the ones swept so far provide
+        // free slots. Sweep the next one before taking a new chunk, so that the heap
+        // doesn't grow just because the sweep isn't finished yet. Sweeping one chunk
+        // per new chunk keeps the pauses short.
+        Chunk *sweptChunk = nullptr;
+        if (nextChunkToSweep < chunksToSweep && !sweptBeforeGrowing) {
+            sweptBeforeGrowing = true;
+            sweptChunk = chunks[nextChunkToSweep];
+            sweepChunks(QDeadlineTimer(0));
+            // Its free slots are in the bins now, unless it's empty.
+            if (Chunk::hasNonZeroBit(sweptChunk->objectBitmap))
+                goto retry;
+        }
+
         if (nFree) {
             // Save any remaining slots of the current chunk
             // for later, smaller allocations.
@@ -532,9 +578,12 @@ HeapItem *BlockAllocator::allocate(size_t size, bool forceAllocation) {
             nextFree->freeData.availableSlots = nFree;
             freeBins[bin] = nextFree;
         }
-        Chunk *newChunk = chunkAllocator->allocate();
-        Q_V4_PROFILE_ALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
-        chunks.push_back(newChunk);
+        Chunk *newChunk = sweptChunk;
+        if (!newChunk) {
+            newChunk = chunkAllocator->allocate();
+            Q_V4_PROFILE_ALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
+            chunks.push_back(newChunk);
+        }
         nextFree = newChunk->first();
         nFree = Chunk::AvailableSlots;
         m = nextFree;
@@ -553,6 +602,20 @@ done:
 }
 
 void BlockAllocator::sweep()
+{
+    startSweep();
+    sweepChunks(QDeadlineTimer(QDeadlineTimer::Forever));
+    finishSweep();
+}
+
+/*!
+    \internal
+    Prepares sweeping all chunks currently owned by the allocator. The chunks can then
+    be swept incrementally by sweepChunks(), with the mutator running in between.
+    Chunks allocated after this call only contain items allocated after the mark phase,
+    and are not swept in the current gc cycle.
+ */
+void BlockAllocator::startSweep()
 {
     nextFree = nullptr;
     nFree = 0;
@@ -560,24 +623,67 @@ void BlockAllocator::sweep()
 
 //    qDebug() << "BlockAlloc: sweep";
     usedSlotsAfterLastSweep = 0;
+    nextChunkToSweep = 0;
+    chunksToSweep = chunks.size();
+
+    // Sweep sparsely populated chunks first. sortIntoBins() prepends to the bins, so the
+    // free slots of the densest chunks end up in front and get allocated from first. This
+    // gives sparse chunks a chance to become empty, so that they can be returned to the OS.
+    std::vector<std::pair<uint, Chunk *>> chunksByLiveItems;
+    chunksByLiveItems.reserve(chunks.size());
+    for (Chunk *c : chunks) {
+        uint liveItems = 0;
+        for (uint i = 0; i < Chunk::EntriesInBitmap; ++i)
+            liveItems += qPopulationCount(c->blackBitmap[i]);
+        chunksByLiveItems.emplace_back(liveItems, c);
+    }
+    std::stable_sort(chunksByLiveItems.begin(), chunksByLiveItems.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (size_t i = 0; i < chunks.size(); ++i)
+        chunks[i] = chunksByLiveItems[i].second;
+}
 
-    auto firstEmptyChunk = std::partition(chunks.begin(), chunks.end(), [this](Chunk *c) {
-        return c->sweep(engine);
-    });
+/*!
+    \internal
+    Sweeps chunks until either all of them are swept, or the \a deadline has expired.
+    At least one chunk is swept per call. The free slots of swept chunks which still
+    contain live items can be allocated from right away.
+    Returns \c true once all chunks have been swept.
+ */
+bool BlockAllocator::sweepChunks(QDeadlineTimer deadline)
+{
+    while (nextChunkToSweep < chunksToSweep) {
+        Chunk *c = chunks[nextChunkToSweep++];
+        if (c->sweep(engine)) {
+            c->sortIntoBins(freeBins, NumBins);
+            usedSlotsAfterLastSweep += c->nUsedSlots();
+        }
+        if (deadline.hasExpired())
+            break;
+    }
+    return nextChunkToSweep == chunksToSweep;
+}
 
-    std::for_each(chunks.begin(), firstEmptyChunk, [this](Chunk *c) {
-        c->sortIntoBins(freeBins, NumBins);
-        usedSlotsAfterLastSweep += c->nUsedSlots();
+void BlockAllocator::finishSweep()
+{
+    Q_ASSERT(nextChunkToSweep == chunksToSweep);
+    const auto sweptChunksEnd = chunks.begin() + chunksToSweep;
+    // empty chunks were never sorted into the bins, so nothing got allocated in them,
+    // unless allocate() took them over as a whole
+    auto firstEmptyChunk = std::partition(chunks.begin(), sweptChunksEnd, [](Chunk *c) {
+        return Chunk::hasNonZeroBit(c->objectBitmap);
     });
 
     // only free the chunks at the end to avoid that the sweep() calls indirectly
     // access freed memory
-    std::for_each(firstEmptyChunk, chunks.end(), [this](Chunk *c) {
+    std::for_each(firstEmptyChunk, sweptChunksEnd, [this](Chunk *c) {
         Q_V4_PROFILE_DEALLOC(engine, Chunk::DataSize, Profiling::HeapPage);
         chunkAllocator->free(c);
     });
 
-    chunks.erase(firstEmptyChunk, chunks.end());
+    chunks.erase(firstEmptyChunk, sweptChunksEnd);
+    nextChunkToSweep = 0;
+    chunksToSweep = 0;
 }
 
 void BlockAllocator::freeAll()
@@ -644,6 +750,22 @@ static void freeHugeChunk(ChunkAllocator *chunkAllocator, const HugeItemAllocato
 }
 
 void HugeItemAllocator::sweep(ClassDestroyStatsCallback classCountPtr)
+{
+    startSweep();
+    finishSweep(classCountPtr);
+}
+
+/*!
+    \internal
+    Remembers which items exist when sweeping starts. Items allocated after this call
+    are not swept in the current gc cycle, as they were not there when marking finished.
+ */
+void HugeItemAllocator::startSweep()
+{
+    chunksToSweep = chunks.size();
+}
+
+void HugeItemAllocator::finishSweep(ClassDestroyStatsCallback classCountPtr)
 {
     auto isBlack = [this, classCountPtr] (const HugeChunk &c) {
         bool b = c.chunk->first()->isBlack();
@@ -655,8 +777,10 @@ void HugeItemAllocator::sweep(ClassDestroyStatsCallback classCountPtr)
         return !b;
     };
 
-    auto newEnd = std::remove_if(chunks.begin(), chunks.end(), isBlack);
-    chunks.erase(newEnd, chunks.end());
+    const auto sweptChunksEnd = chunks.begin() + chunksToSweep;
+    auto newEnd = std::remove_if(chunks.begin(), sweptChunksEnd, isBlack);
+    chunks.erase(newEnd, sweptChunksEnd);
+    chunksToSweep = 0;
 }
 
 void HugeItemAllocator::resetBlackBits()
@@ -870,13 +994,64 @@ GCState handleQObjectWrappers(GCStateMachine *that, ExtraData &)
     return GCState::DoSweep;
 }
 
+/*!
+    \internal
+    Internal classes are only swept once all other items are freed, as the sweep of
+    those reads their internal class. However, the mutator can run while the block
+    allocator is swept, and it must not pick up an unmarked internal class through a
+    transition of a live one: Marking it again would also mark items that have already
+    been freed. So remove such transitions before sweeping starts.
+ */
+void unlinkUnmarkedInternalClasses(BlockAllocator *icAllocator)
+{
+    for (Chunk *c : icAllocator->chunks) {
+        HeapItem *o = c->realBase();
+        for (uint i = 0; i < Chunk::EntriesInBitmap; ++i) {
+            quintptr unmarked = c->objectBitmap[i] & ~c->blackBitmap[i];
+            while (unmarked) {
+                const uint index = qCountTrailingZeroBits(unmarked);
+                unmarked &= unmarked - 1;
+                (o + index)->as<Heap::InternalClass>()->unlinkFromParent();
+            }
+            o += Chunk::Bits;
+        }
+    }
+}
+
 GCState doSweep(GCStateMachine *that, ExtraData &)
 {
     auto mm = that->mm;
 
     mm->engine->identifierTable->sweep();
-    mm->blockAllocator.sweep();
-    mm->hugeItemAllocator.sweep(that->mm->gcCollectorStats ? increaseFreedCountForClass : nullptr);
+    if (mm->engine->megamorphicLookupCache)
+        mm->engine->megamorphicLookupCache->clear();
+    if (mm->engine->appendableString && !mm->engine->appendableString->isMarked())
+        mm->engine->setAppendableString(nullptr);
+    unlinkUnmarkedInternalClasses(&mm->icAllocator);
+    mm->blockAllocator.startSweep();
+    mm->hugeItemAllocator.startSweep();
+    return GCState::SweepBlockAllocator;
+}
+
+GCState sweepBlockAllocator(GCStateMachine *that, ExtraData &)
+{
+    return that->mm->blockAllocator.sweepChunks(that->deadline)
+            ? GCState::FinishSweep
+            : GCState::SweepBlockAllocator;
+}
+
+GCState finishSweep(GCStateMachine *that, ExtraData &)
+{
+    auto mm = that->mm;
+
+    mm->blockAllocator.finishSweep();
+    mm->hugeItemAllocator.finishSweep(
+            that->mm->gcCollectorStats ? increaseFreedCountForClass : nullptr);
+
+    // The mutator may have created internal classes while the block allocator was being
+    // swept, and those share chunks with the ones from before. Mark the ones that are in
+    // use by items on the stack, as those need not have been stored anywhere yet.
+    redrain(that);
     mm->icAllocator.sweep();
 
     // reset all black bits
@@ -980,6 +1155,14 @@ MemoryManager::MemoryManager(ExecutionEngine *engine)
         doSweep,
         false,
     };
+    gcStateMachine->stateInfoMap[GCState::SweepBlockAllocator] = {
+        sweepBlockAllocator,
+        false,
+    };
+    gcStateMachine->stateInfoMap[GCState::FinishSweep] = {
+        finishSweep,
+        false,
+    };
 }
 
 Heap::Base *MemoryManager::allocString(std::size_t unmanagedSize)
@@ -1107,11 +1290,84 @@ void MemoryManager::onEventLoop()
         }, Qt::QueuedConnection);
         return;
     }
+    if (!eventLoopStepsDeferredUntil.hasExpired()) {
+        scheduleGCStep();
+        return;
+    }
     if (gcStateMachine->inProgress()) {
         gcStateMachine->step();
     }
 }
 
+/*!
+    \internal
+    Makes sure that the on-going gc cycle continues later. Normally, the next
+    step is run from the event loop. While steps are deferred by
+    runGCInIdleTime(), a single fallback step is scheduled for the time the
+    deferral ends, in case the caller doesn't provide idle time in time.
+ */
+void MemoryManager::scheduleGCStep()
+{
+    if (eventLoopStepsDeferredUntil.hasExpired()) {
+        QMetaObject::invokeMethod(engine->publicEngine, [this]{
+            onEventLoop();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // Without an end to the deferral, there is nothing to fall back to.
+    if (deferredGCStepScheduled || eventLoopStepsDeferredUntil.isForever())
+        return;
+    deferredGCStepScheduled = true;
+    const int remaining = int(qBound<qint64>(0, eventLoopStepsDeferredUntil.remainingTime(), INT_MAX));
+    QTimer::singleShot(remaining, engine->publicEngine, [this]{
+        deferredGCStepScheduled = false;
+        onEventLoop();
+    });
+}
+
+/*!
+    \internal
+    Runs incremental gc steps until \a deadline expires. If no gc cycle is in
+    progress, but the next allocation would start one anyway, it is started
+    right away, so that it doesn't start at a less convenient time.
+
+    Until \a deferEventLoopStepsUntil expires, no steps are run from the event
+    loop. The caller promises to call this function again before that. The
+    Qt Quick render loops use this to run the gc in between frames instead of
+    in the middle of them, using all of the time left until the next frame.
+ */
+void MemoryManager::runGCInIdleTime(QDeadlineTimer deadline, QDeadlineTimer deferEventLoopStepsUntil)
+{
+    eventLoopStepsDeferredUntil = deferEventLoopStepsUntil;
+
+    if (engine->inShutdown || gcBlocked == InCriticalSection || deadline.hasExpired())
+        return;
+
+    const bool incrementalGCIsAlreadyRunning = gcStateMachine->inProgress();
+    if (!incrementalGCIsAlreadyRunning && !shouldRunGC() && !isAboveUnmanagedHeapLimit())
+        return;
+
+    // a non-incremental gc was explicitly requested, there is nothing to spread out
+    if (gcStateMachine->timeLimit.count() <= 0) {
+        if (!incrementalGCIsAlreadyRunning)
+            runGC();
+        return;
+    }
+
+    const auto idleTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline.remainingTimeAsDuration());
+    if (idleTime.count() <= 0)
+        return;
+
+    auto oldTimeLimit = std::exchange(gcStateMachine->timeLimit, idleTime);
+    if (incrementalGCIsAlreadyRunning)
+        gcStateMachine->step();
+    else
+        runGC();
+    gcStateMachine->timeLimit = oldTimeLimit;
+}
+
 
 void MemoryManager::setGCTimeLimit(int timeMs)
 {
@@ -1139,6 +1395,10 @@ void MemoryManager::sweep(bool lastSweep, ClassDestroyStatsCallback classCountPt
 
     if (!lastSweep) {
         engine->identifierTable->sweep();
+        if (engine->megamorphicLookupCache)
+            engine->megamorphicLookupCache->clear();
+        if (engine->appendableString && !engine->appendableString->isMarked())
+            engine->setAppendableString(nullptr);
         blockAllocator.sweep(/*classCountPtr*/);
         hugeItemAllocator.sweep(classCountPtr);
         icAllocator.sweep(/*classCountPtr*/);
@@ -1302,7 +1562,7 @@ void MemoryManager::runGC()
 #endif
         size_t oldChunks = blockAllocator.chunks.size();
         qDebug(stats) << "Allocated" << totalMem << "bytes in" << oldChunks << "chunks";
-        qDebug(stats) << "Fragmented memory before GC" << (totalMem - usedBefore);
+        qDebug(stats) << "Fragmented memory before GC" << getFragmentedMem();
         dumpBins(&blockAllocator, "Block");
         dumpBins(&icAllocator, "InternalClass");
 
@@ -1342,6 +1602,7 @@ void MemoryManager::runGC()
         qDebug(stats) << "Used memory after GC:" << usedAfter;
         qDebug(stats) << "Freed up bytes      :" << (usedBefore - usedAfter);
         qDebug(stats) << "Freed up chunks     :" << (oldChunks - blockAllocator.chunks.size());
+        qDebug(stats) << "Fragmented memory after GC:" << getFragmentedMem();
         size_t lost = blockAllocator.allocatedMem() + icAllocator.allocatedMem()
                 - memInBins - usedAfter;
         if (lost)
@@ -1359,8 +1620,16 @@ void MemoryManager::runGC()
         qDebug(stats) << "======== End GC ========";
     }
 
-    if (gcStats)
+    if (gcStats) {
         statistics.maxUsedMem = qMax(statistics.maxUsedMem, getUsedMem() + getLargeItemsMem());
+        statistics.maxFragmentedMem = qMax(statistics.maxFragmentedMem, getFragmentedMem());
+        size_t latin1TextMem = 0;
+        const size_t stringTextMem = getStringTextMem(&latin1TextMem);
+        if (stringTextMem > statistics.maxStringTextMem) {
+            statistics.maxStringTextMem = stringTextMem;
+            statistics.latin1TextMemAtMaxStringTextMem = latin1TextMem;
+        }
+    }
 }
 
 size_t MemoryManager::getUsedMem() const
@@ -1378,6 +1647,48 @@ size_t MemoryManager::getLargeItemsMem() const
     return hugeItemAllocator.usedMem();
 }
 
+/*!
+    \internal
+    Returns the amount of memory in the chunks of the block and IC allocators which
+    is not used by any item. Such memory can only be returned to the OS once all items
+    in a chunk are dead, as items are never moved.
+ */
+size_t MemoryManager::getFragmentedMem() const
+{
+    return blockAllocator.allocatedMem() + icAllocator.allocatedMem() - getUsedMem();
+}
+
+// Walks the heap, so only use it for statistics
+size_t MemoryManager::getStringTextMem(size_t *latin1TextMem) const
+{
+    size_t total = 0;
+    size_t latin1 = 0;
+    for (Chunk *c : blockAllocator.chunks) {
+        HeapItem *o = c->realBase();
+        for (uint i = 0; i < Chunk::EntriesInBitmap; ++i) {
+            quintptr objects = c->objectBitmap[i];
+            while (objects) {
+                const uint index = qCountTrailingZeroBits(objects);
+                objects &= objects - 1;
+                const Heap::Base *b = (o + index)->as<Heap::Base>();
+                if (!b->internalClass || !b->internalClass->vtable->isString)
+                    continue;
+                const Heap::String *string = static_cast<const Heap::String *>(b);
+                const size_t size = string->retainedTextSize();
+                if (!size)
+                    continue;
+                total += size;
+                const QStringPrivate &text = string->text();
+                if (QtPrivate::isLatin1(QStringView(text.data(), text.size)))
+                    latin1 += size;
+            }
+            o += Chunk::Bits;
+        }
+    }
+    *latin1TextMem = latin1;
+    return total;
+}
+
 void MemoryManager::updateUnmanagedHeapSizeGCLimit()
 {
     if (3*unmanagedHeapSizeGCLimit <= 4 * unmanagedHeapSize) {
@@ -1454,6 +1765,10 @@ void MemoryManager::dumpStats() const
     qDebug(stats) << "Total memory allocated:" << statistics.maxReservedMem;
     qDebug(stats) << "Max memory used before a GC run:" << statistics.maxAllocatedMem;
     qDebug(stats) << "Max memory used after a GC run:" << statistics.maxUsedMem;
+    qDebug(stats) << "Max fragmented memory after a GC run:" << statistics.maxFragmentedMem;
+    qDebug(stats) << "Max memory used by string data after a GC run:" << statistics.maxStringTextMem;
+    qDebug(stats) << "    of which strings that fit into Latin-1:" << statistics.latin1TextMemAtMaxStringTextMem;
+    qDebug(stats) << "    memory saved if those were stored in Latin-1:" << statistics.latin1TextMemAtMaxStringTextMem / 2;
     qDebug(stats) << "Requests for different item sizes:";
     for (int i = 1; i < BlockAllocator::NumBins - 1; ++i)
         qDebug(stats) << "     <" << (i << Chunk::SlotSizeShift) << " bytes: " << statistics.allocations[i];
@@ -1531,6 +1846,7 @@ static GCState executeWithLoggingIfEnabled(GCStateMachine* that, GCStateInfo& st
 
 void GCStateMachine::transition() {
     if (timeLimit.count() > 0) {
+        Q_TRACE_SCOPE(QQmlV4_gc_step, mm->engine, int(state), qint64(timeLimit.count()));
         deadline = QDeadlineTimer(timeLimit);
         bool deadlineExpired = false;
         while (!(deadlineExpired = deadline.hasExpired()) && state != GCState::Invalid) {
@@ -1558,9 +1874,7 @@ void GCStateMachine::transition() {
         if (deadlineExpired)
             handleTimeout(state);
         if (state != GCState::Invalid)
-            QMetaObject::invokeMethod(mm->engine->publicEngine, [this]{
-                mm->onEventLoop();
-            }, Qt::QueuedConnection);
+            mm->scheduleGCStep();
     } else {
         deadline = QDeadlineTimer::Forever;
         while (state != GCState::Invalid) {
@@ -54,6 +54,8 @@ public:
         FreeWeakSets,
         HandleQObjectWrappers,
         DoSweep,
+        SweepBlockAllocator,
+        FinishSweep,
         Invalid,
         Count,
     };
@@ -140,6 +142,9 @@ struct BlockAllocator {
     }
 
     void sweep();
+    void startSweep();
+    bool sweepChunks(QDeadlineTimer deadline);
+    void finishSweep();
     void freeAll();
     void resetBlackBits();
 
@@ -147,6 +152,9 @@ struct BlockAllocator {
     HeapItem *nextFree = nullptr;
     size_t nFree = 0;
     size_t usedSlotsAfterLastSweep = 0;
+    // incremental sweeping; chunks at or after chunksToSweep were added during the sweep
+    size_t nextChunkToSweep = 0;
+    size_t chunksToSweep = 0;
     HeapItem *freeBins[NumBins];
     ChunkAllocator *chunkAllocator;
     ExecutionEngine *engine;
@@ -161,6 +169,8 @@ struct HugeItemAllocator {
 
     HeapItem *allocate(size_t size);
     void sweep(ClassDestroyStatsCallback classCountPtr);
+    void startSweep();
+    void finishSweep(ClassDestroyStatsCallback classCountPtr);
     void freeAll();
     void resetBlackBits();
 
@@ -180,6 +190,8 @@ struct HugeItemAllocator {
     };
 
     std::vector<HugeChunk> chunks;
+    // chunks at or after chunksToSweep were added during the sweep
+    size_t chunksToSweep = 0;
 };
 
 
@@ -255,9 +267,10 @@ public:
     }
 
     template <typename ObjectType>
-    typename ObjectType::Data *allocateObject(Heap::InternalClass *ic)
+    typename ObjectType::Data *allocateObject(Heap::InternalClass *ic, uint nMembers = 0)
     {
-        Heap::Object *o = allocObjectWithMemberData(ObjectType::staticVTable(), ic->size);
+        Heap::Object *o = allocObjectWithMemberData(ObjectType::staticVTable(),
+                                                    qMax(ic->size, nMembers));
         o->internalClass.set(engine, ic);
         Q_ASSERT(o->internalClass.get() && o->vtable());
         Q_ASSERT(o->vtable() == ObjectType::staticVTable());
@@ -298,6 +311,17 @@ public:
         return d;
     }
 
+    // Like allocObject(), but with room for at least nMembers properties, so
+    // that adding properties up to that number doesn't grow the member data.
+    template <typename ObjectType, typename... Args>
+    typename ObjectType::Data *allocObjectWithCapacity(
+            uint nMembers, Heap::InternalClass *ic, Args&&... args)
+    {
+        typename ObjectType::Data *d = allocateObject<ObjectType>(ic, nMembers);
+        d->init(std::forward<Args>(args)...);
+        return d;
+    }
+
     template <typename ObjectType, typename... Args>
     typename ObjectType::Data *allocObject(InternalClass *ic, Args&&... args)
     {
@@ -333,6 +357,8 @@ public:
     size_t getUsedMem() const;
     size_t getAllocatedMem() const;
     size_t getLargeItemsMem() const;
+    size_t getFragmentedMem() const;
+    size_t getStringTextMem(size_t *latin1TextMem) const;
 
     // called when a JS object grows itself. Specifically: Heap::String::append
     // and InternalClassDataPrivate<PropertyAttributes>.
@@ -352,6 +378,8 @@ public:
     void registerWeakSet(Heap::SetObject *set);
 
     void onEventLoop();
+    void scheduleGCStep();
+    void runGCInIdleTime(QDeadlineTimer deadline, QDeadlineTimer deferEventLoopStepsUntil);
 
     //GC related methods
     void setGCTimeLimit(int timeMs);
@@ -432,6 +460,9 @@ public:
 
     enum Blockness : quint8 {Unblocked, NormalBlocked, InCriticalSection };
     Blockness gcBlocked = Unblocked;
+    // set by runGCInIdleTime(); until it expires, no gc steps are run from the event loop
+    QDeadlineTimer eventLoopStepsDeferredUntil;
+    bool deferredGCStepScheduled = false;
     bool aggressiveGC = false;
     bool gcStats = false;
     bool gcCollectorStats = false;
@@ -443,6 +474,9 @@ public:
         size_t maxReservedMem = 0;
         size_t maxAllocatedMem = 0;
         size_t maxUsedMem = 0;
+        size_t maxFragmentedMem = 0;
+        size_t maxStringTextMem = 0;
+        size_t latin1TextMemAtMaxStringTextMem = 0;
         uint allocations[BlockAllocator::NumBins];
     } statistics;
 };
@@ -164,6 +164,8 @@ public:
     };
     QIntrusiveList<Incubator, &Incubator::next> incubatorList;
     unsigned int incubatorCount = 0;
+    // Incubators in incubatorList with a priority other than NormalPriority
+    unsigned int prioritizedIncubatorCount = 0;
     QQmlIncubationController *incubationController = nullptr;
     void incubate(QQmlIncubator &, const QQmlRefPointer<QQmlContextData> &);
 
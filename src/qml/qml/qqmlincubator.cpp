@@ -55,6 +55,8 @@ void QQmlEnginePrivate::incubate(
     } else {
         incubatorList.insert(p.data());
         incubatorCount++;
+        if (p->priority != QQmlIncubator::NormalPriority)
+            prioritizedIncubatorCount++;
 
         p->vmeGuard.guard(p->creator.data());
         p->changeStatus(QQmlIncubator::Loading);
@@ -110,6 +112,8 @@ void QQmlIncubatorPrivate::clear()
     if (next.isInList()) {
         next.remove();
         enginePriv->incubatorCount--;
+        if (priority != QQmlIncubator::NormalPriority)
+            enginePriv->prioritizedIncubatorCount--;
         QQmlIncubationController *controller = enginePriv->incubationController;
         if (controller)
              controller->incubatingObjectCountChanged(enginePriv->incubatorCount);
@@ -413,8 +417,45 @@ void QQmlIncubatorPrivate::incubateCppBasedComponent(QQmlComponent *component, Q
 
 }
 
+/*!
+\internal
+The priority an incubator is processed with. Nested incubators inherit the priority of the
+incubators waiting for them, so that they don't hold up more important work.
+*/
+QQmlIncubator::Priority QQmlIncubatorPrivate::effectivePriority() const
+{
+    QQmlIncubator::Priority result = priority;
+    for (const QQmlIncubatorPrivate *p = waitingOnMe.data(); p; p = p->waitingOnMe.data())
+        result = qMax(result, p->priority);
+    return result;
+}
+
+// Continue with the most recently started incubator of the highest priority.
+static QQmlIncubatorPrivate *nextIncubator(QQmlEnginePrivate *enginePriv)
+{
+    // Without any priorities set, all incubators are equally important.
+    if (!enginePriv->prioritizedIncubatorCount)
+        return static_cast<QQmlIncubatorPrivate *>(enginePriv->incubatorList.first());
+
+    QQmlIncubatorPrivate *next = nullptr;
+    QQmlIncubator::Priority nextPriority = QQmlIncubator::LowPriority;
+    for (QQmlEnginePrivate::Incubator *incubator : enginePriv->incubatorList) {
+        QQmlIncubatorPrivate *candidate = static_cast<QQmlIncubatorPrivate *>(incubator);
+        const QQmlIncubator::Priority priority = candidate->effectivePriority();
+        if (!next || priority > nextPriority) {
+            next = candidate;
+            nextPriority = priority;
+            if (priority == QQmlIncubator::HighPriority)
+                break;
+        }
+    }
+    return next;
+}
+
 /*!
 Incubate objects for \a msecs, or until there are no more objects to incubate.
+
+Objects are incubated in the order of their incubators' \l{QQmlIncubator::priority()}{priority}.
 */
 void QQmlIncubationController::incubateFor(int msecs)
 {
@@ -424,7 +465,7 @@ void QQmlIncubationController::incubateFor(int msecs)
     QDeadlineTimer deadline(msecs);
     QQmlInstantiationInterrupt i(deadline);
     do {
-        static_cast<QQmlIncubatorPrivate*>(d->incubatorList.first())->incubate(i);
+        nextIncubator(d)->incubate(i);
     } while (d && d->incubatorCount != 0 && !i.shouldInterrupt());
 }
 
@@ -447,7 +488,7 @@ void QQmlIncubationController::incubateWhile(std::atomic<bool> *flag, int msecs)
 
     QQmlInstantiationInterrupt i(flag, msecs ? QDeadlineTimer(msecs) : QDeadlineTimer::Forever);
     do {
-        static_cast<QQmlIncubatorPrivate*>(d->incubatorList.first())->incubate(i);
+        nextIncubator(d)->incubate(i);
     } while (d && d->incubatorCount != 0 && !i.shouldInterrupt());
 }
 
@@ -544,6 +585,10 @@ It is almost always incorrect to use the Synchronous incubation mode - elements
 want the appearance of synchronous instantiation, but without the downsides of introducing freezes
 or stutters into the application, should use the AsynchronousIfNested incubation mode.
 \endlist
+
+Asynchronous incubators can be given a \l{QQmlIncubator::Priority}{priority}, so that, for
+example, delegates that are about to become visible are created before delegates that are merely
+prefetched.
 */
 
 /*!
@@ -592,6 +637,22 @@ Specifies the status of the QQmlIncubator.
 \value Error An error occurred.  The errors can be access by calling errors().
 */
 
+/*!
+\enum QQmlIncubator::Priority
+\since 6.9
+
+Specifies in which order asynchronous incubators are processed. The incubation controller
+processes incubators of higher priority first. Nested incubators are processed with at least the
+priority of the incubators waiting for them.
+
+\value LowPriority Objects that are created ahead of time while the application is idle, for
+example pages the user may navigate to later.
+\value NormalPriority Objects that are needed soon, for example delegates that are prefetched
+slightly off screen. This is the default.
+\value HighPriority Objects that are needed as soon as possible, for example delegates that are
+about to become visible.
+*/
+
 /*!
 Clears the incubator.  Any in-progress incubation is aborted.  If the incubator is in the
 Ready state, the created object is \b not deleted.
@@ -693,6 +754,42 @@ QQmlIncubator::IncubationMode QQmlIncubator::incubationMode() const
     return d->mode;
 }
 
+/*!
+\since 6.9
+
+Return the priority of the incubator.
+
+\sa setPriority()
+*/
+QQmlIncubator::Priority QQmlIncubator::priority() const
+{
+    return d->priority;
+}
+
+/*!
+\since 6.9
+
+Set the priority of the incubator to \a priority. The default is NormalPriority.
+
+When the incubation controller processes asynchronous incubators, it always continues with an
+incubator of the highest priority available. Among incubators of the same priority, the one
+started last is processed first. The priority can be changed at any time, for example when an
+object that was prefetched becomes visible. It only affects asynchronous incubation.
+
+\sa QQmlIncubationController::incubateFor()
+*/
+void QQmlIncubator::setPriority(Priority priority)
+{
+    if (d->next.isInList()) {
+        unsigned int &prioritized = d->enginePriv->prioritizedIncubatorCount;
+        if (d->priority != NormalPriority)
+            prioritized--;
+        if (priority != NormalPriority)
+            prioritized++;
+    }
+    d->priority = priority;
+}
+
 /*!
 Return the current status of the incubator.
 */
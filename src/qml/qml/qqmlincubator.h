@@ -31,6 +31,11 @@ public:
         Loading,
         Error
     };
+    enum Priority {
+        LowPriority,
+        NormalPriority,
+        HighPriority
+    };
 
     QQmlIncubator(IncubationMode = Asynchronous);
     virtual ~QQmlIncubator();
@@ -47,6 +52,9 @@ public:
 
     IncubationMode incubationMode() const;
 
+    Priority priority() const;
+    void setPriority(Priority priority);
+
     Status status() const;
 
     QObject *object() const;
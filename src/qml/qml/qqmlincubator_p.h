@@ -46,6 +46,7 @@ public:
     QQmlIncubator::Status status;
 
     QQmlIncubator::IncubationMode mode;
+    QQmlIncubator::Priority priority = QQmlIncubator::NormalPriority;
     bool isAsynchronous;
     enum Progress : char { Execute, Completing, Completed };
     Progress progress;
@@ -80,6 +81,7 @@ public:
 
     void forceCompletion(QQmlInstantiationInterrupt &i);
     void incubate(QQmlInstantiationInterrupt &i);
+    QQmlIncubator::Priority effectivePriority() const;
     void incubateCppBasedComponent(QQmlComponent *component, QQmlContext *context);
     RequiredProperties *requiredProperties();
     bool hadTopLevelRequiredProperties() const;
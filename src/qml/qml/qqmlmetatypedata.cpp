@@ -165,7 +165,9 @@ QQmlPropertyCache::ConstPtr QQmlMetaTypeData::propertyCache(
     const QTypeRevision maxVersion = QTypeRevision::fromVersion(combinedVersion.majorVersion(),
                                                                 maxMinorVersion);
     if (auto pc = propertyCacheForVersion(type.index(), maxVersion)) {
-        setPropertyCacheForVersion(type.index(), maxVersion, pc);
+        // Remember it for the requested version, too, so that we don't have to walk the
+        // meta object hierarchy again next time.
+        setPropertyCacheForVersion(type.index(), version, pc);
         return pc;
     }
 
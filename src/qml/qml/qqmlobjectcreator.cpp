@@ -1247,14 +1247,17 @@ void QQmlObjectCreator::setupFunctions()
 {
     QV4::Scope scope(v4);
     QV4::ScopedValue function(scope);
+    QV4::ScopedString name(scope);
     QV4::ScopedContext qmlContext(scope, currentQmlContext());
 
     const quint32_le *functionIdx = _compiledObject->functionOffsetTable();
     for (quint32 i = 0; i < _compiledObject->nFunctions; ++i, ++functionIdx) {
         QV4::Function *runtimeFunction = compilationUnit->runtimeFunctions[*functionIdx];
-        const QString name = runtimeFunction->name()->toQString();
 
-        const QQmlPropertyData *property = _propertyCache->property(name, _qobject, context);
+        // Look up the name as it is, rather than converting it to a QString for every instance.
+        name = runtimeFunction->name();
+        const QQmlPropertyData *property
+                = _propertyCache->property(name.getPointer(), _qobject, context);
         if (!property->isVMEFunction())
             continue;
 
@@ -41,6 +41,13 @@ static int metaObjectSignalCount(const QMetaObject *metaObject)
 
 QQmlPropertyData::Flags
 QQmlPropertyData::flagsForProperty(const QMetaProperty &p)
+{
+    return flagsForProperty(p, p.metaType());
+}
+
+// Resolving the meta type of a property can involve a lookup by name. Pass it if you have it.
+QQmlPropertyData::Flags
+QQmlPropertyData::flagsForProperty(const QMetaProperty &p, QMetaType metaType)
 {
     QQmlPropertyData::Flags flags;
 
@@ -51,8 +58,6 @@ QQmlPropertyData::flagsForProperty(const QMetaProperty &p)
     flags.setIsRequired(p.isRequired());
     flags.setIsBindable(p.isBindable());
 
-
-    const QMetaType metaType = p.metaType();
     int propType = metaType.id();
     if (p.isEnumType()) {
         flags.setType(QQmlPropertyData::Flags::EnumType);
@@ -72,9 +77,9 @@ void QQmlPropertyData::load(const QMetaProperty &p)
     Q_ASSERT(p.revision() <= std::numeric_limits<quint16>::max());
     setCoreIndex(p.propertyIndex());
     setNotifyIndex(QMetaObjectPrivate::signalIndex(p.notifySignal()));
-    setFlags(flagsForProperty(p));
+    const QMetaType type = p.metaType();
+    setFlags(flagsForProperty(p, type));
     setRevision(QTypeRevision::fromEncodedVersion(p.revision()));
-    QMetaType type = p.metaType();
     setPropType(type);
 }
 
@@ -515,6 +520,14 @@ void QQmlPropertyCache::append(const QMetaObject *metaObject,
     int propCount = metaObject->propertyCount();
     int propOffset = metaObject->propertyOffset();
 
+    bool isGadget = true;
+    for (const QMetaObject *it = metaObject; it != nullptr; it = it->superClass()) {
+        if (it == &QObject::staticMetaObject) {
+            isGadget = false;
+            break;
+        }
+    }
+
     // update() should have reserved enough space in the vector that this doesn't cause a realloc
     // and invalidate the stringCache.
     propertyIndexCache.resize(propCount - propertyIndexCacheStart);
@@ -562,12 +575,6 @@ void QQmlPropertyCache::append(const QMetaObject *metaObject,
             setNamedProperty(propName, ii, data);
         }
 
-        bool isGadget = true;
-        for (const QMetaObject *it = metaObject; it != nullptr; it = it->superClass()) {
-            if (it == &QObject::staticMetaObject)
-                isGadget = false;
-        }
-
         // otherwise always dispatch over a 'normal' meta-call so the QQmlValueType can intercept
         if (!isGadget)
             data->trySetStaticMetaCallFunction(metaObject->d.static_metacall, ii - propOffset);
@@ -336,6 +336,7 @@ public:
     quint16 relativePropertyIndex() const { Q_ASSERT(hasStaticMetaCallFunction()); return m_flags.otherBits; }
 
     static Flags flagsForProperty(const QMetaProperty &);
+    static Flags flagsForProperty(const QMetaProperty &, QMetaType metaType);
     void load(const QMetaProperty &);
     void load(const QMetaMethod &);
 
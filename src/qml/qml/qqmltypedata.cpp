@@ -11,6 +11,7 @@
 #include <private/qqmlscriptdata_p.h>
 #include <private/qqmltypecompiler_p.h>
 #include <private/qqmltypedata_p.h>
+#include <private/qqmltypeloaderparsepool_p.h>
 #include <private/qqmltypeloaderqmldircontent_p.h>
 
 #include <QtCore/qloggingcategory.h>
@@ -656,6 +657,11 @@ void QQmlTypeData::dataReceived(const SourceCodeData &data)
 
     m_backupSourceCode = data;
 
+    // If we don't get to loadFromSource(), a document parsed ahead of time is useless.
+    const auto discardPreparsed = qScopeGuard([this]() {
+        typeLoader()->parsePool()->discard(url());
+    });
+
     if (tryLoadFromDiskCache())
         return;
 
@@ -703,10 +709,6 @@ bool QQmlTypeData::loadFromSource()
 {
     assertTypeLoaderThread();
 
-    m_document.reset(new QmlIR::Document(isDebugging()));
-    m_document->jsModule.sourceTimeStamp = m_backupSourceCode.sourceTimeStamp();
-    QmlIR::IRBuilder compiler;
-
     QString sourceError;
     const QString source = m_backupSourceCode.readAll(&sourceError);
     if (!sourceError.isEmpty()) {
@@ -714,6 +716,17 @@ bool QQmlTypeData::loadFromSource()
         return false;
     }
 
+    if (std::unique_ptr<QmlIR::Document> preparsed
+            = typeLoader()->parsePool()->take(url(), source)) {
+        m_document.reset(preparsed.release());
+        m_document->jsModule.sourceTimeStamp = m_backupSourceCode.sourceTimeStamp();
+        return true;
+    }
+
+    m_document.reset(new QmlIR::Document(isDebugging()));
+    m_document->jsModule.sourceTimeStamp = m_backupSourceCode.sourceTimeStamp();
+    QmlIR::IRBuilder compiler;
+
     if (!compiler.generateFromQml(source, finalUrlString(), m_document.data())) {
         QList<QQmlError> errors;
         errors.reserve(compiler.errors.size());
@@ -963,6 +976,12 @@ void QQmlTypeData::resolveTypes()
         }
     }
 
+    // Resolve all references before loading any of them. Loading a type from a local file
+    // recursively loads its dependencies right away. This way, the files we are going to
+    // load can meanwhile be parsed in parallel.
+    QList<int> loadOrder;
+    loadOrder.reserve(m_typeReferences.size());
+
     for (QV4::CompiledData::TypeReferenceMap::ConstIterator unresolvedRef = m_typeReferences.constBegin(), end = m_typeReferences.constEnd();
          unresolvedRef != end; ++unresolvedRef) {
 
@@ -978,12 +997,32 @@ void QQmlTypeData::resolveTypes()
 
         if (!resolveType(name, version, ref, unresolvedRef->location.line(),
                          unresolvedRef->location.column(), reportErrors,
-                         QQmlType::AnyRegistrationType, selfReferenceDetection) && reportErrors)
+                         QQmlType::AnyRegistrationType, selfReferenceDetection) && reportErrors) {
+            // The types resolved so far won't be loaded. Don't keep their documents around.
+            for (int key : std::as_const(loadOrder)) {
+                const TypeReference resolved = m_resolvedTypes.value(key);
+                if (resolved.type.isComposite() && !resolved.selfReference)
+                    typeLoader()->discardPreparsedType(resolved.type.sourceUrl());
+            }
             return;
+        }
+
+        if (ref.type.isComposite() && !ref.selfReference)
+            typeLoader()->preparseType(ref.type.sourceUrl());
+
+        ref.version = version;
+        ref.location = unresolvedRef->location;
+        ref.needsCreation = unresolvedRef->needsCreation;
+        m_resolvedTypes.insert(unresolvedRef.key(), ref);
+        loadOrder.append(unresolvedRef.key());
+    }
 
+    for (int key : std::as_const(loadOrder)) {
+        const TypeReference ref = m_resolvedTypes.value(key);
         if (ref.type.isComposite() && !ref.selfReference) {
-            ref.typeData = typeLoader()->getType(ref.type.sourceUrl());
-            addDependency(ref.typeData.data());
+            auto typeData = typeLoader()->getType(ref.type.sourceUrl());
+            addDependency(typeData.data());
+            m_resolvedTypes[key].typeData = typeData;
         }
         if (ref.type.isInlineComponentType()) {
             QUrl containingTypeUrl = ref.type.sourceUrl();
@@ -991,16 +1030,11 @@ void QQmlTypeData::resolveTypes()
             if (!containingTypeUrl.isEmpty()) {
                 auto typeData = typeLoader()->getType(containingTypeUrl);
                 if (typeData.data() != this) {
-                    ref.typeData = typeData;
                     addDependency(typeData.data());
+                    m_resolvedTypes[key].typeData = typeData;
                 }
             }
         }
-
-        ref.version = version;
-        ref.location = unresolvedRef->location;
-        ref.needsCreation = unresolvedRef->needsCreation;
-        m_resolvedTypes.insert(unresolvedRef.key(), ref);
     }
 
     // ### this allows enums to work without explicit import or instantiation of the type
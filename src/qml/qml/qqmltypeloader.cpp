@@ -9,6 +9,7 @@
 #include <private/qqmlscriptdata_p.h>
 #include <private/qqmlsourcecoordinate_p.h>
 #include <private/qqmltypedata_p.h>
+#include <private/qqmltypeloaderparsepool_p.h>
 #include <private/qqmltypeloaderqmldircontent_p.h>
 #include <private/qqmltypeloaderthread_p.h>
 #include <private/qv4compiler_p.h>
@@ -1173,6 +1174,79 @@ QQmlRefPointer<QQmlQmldirData> QQmlTypeLoader::getQmldir(const QUrl &url)
     return qmldirData;
 }
 
+/*!
+Starts resolving imports of the modules given by \a uris on the type loader thread and returns
+right away.
+
+Resolving imports locates and parses the modules' qmldir files, loads their plugins and registers
+their types. Call this as early as possible during startup, after setting up import paths and URL
+interceptors, so that this work overlaps with whatever else the application does before loading
+its first component. Modules that cannot be found are ignored here. They are reported when a
+component actually imports them.
+*/
+void QQmlTypeLoader::preloadImports(const QStringList &uris)
+{
+    ASSERT_ENGINETHREAD();
+
+    // One document per module, so that a module that can't be found doesn't hold up the others.
+    for (const QString &uri : uris) {
+        const QString source = QLatin1String("import QtQml\nimport ") + uri
+                + QLatin1String("\nQtObject {}\n");
+        m_preloadedImports.append(getType(source.toUtf8(), QUrl(), Asynchronous));
+    }
+}
+
+/*!
+Schedules the QML file at \a unNormalizedUrl to be parsed on one of the parse pool's worker
+threads, so that a later getType() for the same URL finds its document ready.
+
+This is only a hint. Files that are already known, that are compiled ahead of time, or that
+will probably be loaded from the disk cache are not parsed ahead of time.
+*/
+void QQmlTypeLoader::preparseType(const QUrl &unNormalizedUrl)
+{
+    ASSERT_LOADTHREAD();
+
+    QQmlTypeLoaderParsePool *pool = m_thread->parsePool();
+    if (!pool->isEnabled() || hasUrlInterceptors())
+        return;
+
+    const QUrl url = normalize(unNormalizedUrl);
+    if (!QQmlFile::isSynchronous(url))
+        return;
+
+    {
+        LockHolder<QQmlTypeLoader> holder(this);
+        if (m_typeCache.contains(url))
+            return;
+    }
+
+    QQmlMetaType::CachedUnitLookupError error = QQmlMetaType::CachedUnitLookupError::NoError;
+    if (QQmlMetaType::findCachedCompilationUnit(url, QQmlMetaType::AcceptUntyped, &error))
+        return;
+
+    const QString fileName = QQmlFile::urlToLocalFileOrQrc(url);
+    if ((m_diskCacheOptions & QV4::ExecutionEngine::DiskCache::QmlcRead)
+            && QQmlFile::isLocalFile(url)
+            && (QFile::exists(fileName + QLatin1Char('c'))
+                || QFile::exists(QV4::CompiledData::CompilationUnit::localCacheFilePath(url)))) {
+        return;
+    }
+
+    pool->parse(url, fileName);
+}
+
+/*!
+\internal
+Drops the document scheduled by preparseType() for \a unNormalizedUrl, if nobody is going to
+load it after all.
+*/
+void QQmlTypeLoader::discardPreparsedType(const QUrl &unNormalizedUrl)
+{
+    ASSERT_LOADTHREAD();
+    m_thread->parsePool()->discard(normalize(unNormalizedUrl));
+}
+
 /*!
 Returns the absolute filename of path via a directory cache.
 Returns a empty string if the path does not exist.
@@ -1454,6 +1528,7 @@ void QQmlTypeLoader::clearCache()
     m_importDirCache.clear();
     m_importQmlDirCache.clear();
     m_checksumCache.clear();
+    m_preloadedImports.clear();
 
     // The thread will auto-restart next time we need it.
 }
@@ -39,6 +39,7 @@ class QQmlEngineExtensionInterface;
 class QQmlExtensionInterface;
 class QQmlProfiler;
 class QQmlTypeLoaderThread;
+class QQmlTypeLoaderParsePool;
 class QQmlEngine;
 
 class Q_QML_EXPORT QQmlTypeLoader
@@ -164,6 +165,11 @@ public:
     QQmlRefPointer<QQmlScriptBlob> getScript(const QUrl &unNormalizedUrl, const QUrl &relativeUrl);
     QQmlRefPointer<QQmlQmldirData> getQmldir(const QUrl &);
 
+    void preparseType(const QUrl &unNormalizedUrl);
+    void discardPreparsedType(const QUrl &unNormalizedUrl);
+    void preloadImports(const QStringList &uris);
+    QQmlTypeLoaderParsePool *parsePool() { return ensureThread()->parsePool(); }
+
     QString absoluteFilePath(const QString &path);
     bool fileExists(const QString &path, const QString &file);
     bool directoryExists(const QString &path);
@@ -259,6 +265,7 @@ private:
     ImportDirCache m_importDirCache;
     ImportQmlDirCache m_importQmlDirCache;
     ChecksumCache m_checksumCache;
+    QList<QQmlRefPointer<QQmlTypeData>> m_preloadedImports;
     int m_typeCacheTrimThreshold;
 
     QV4::ExecutionEngine::DiskCacheOptions m_diskCacheOptions
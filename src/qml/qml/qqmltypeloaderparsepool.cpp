@@ -0,0 +1,161 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <private/qqmlirbuilder_p.h>
+#include <private/qqmltypeloaderparsepool_p.h>
+
+#include <QtCore/qfile.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+// The type loader thread parses, too. Beyond a handful of workers we mostly contend for the disk.
+static const int MaximumParseThreads = 4;
+
+struct QQmlTypeLoaderParsePool::Job
+{
+    enum State { Queued, Running, Finished, Cancelled };
+
+    QUrl url;
+    QString fileName;
+    QString source;
+    std::unique_ptr<QmlIR::Document> document;
+    State state = Queued;
+};
+
+QQmlTypeLoaderParsePool::QQmlTypeLoaderParsePool(bool isDebugging)
+    : m_isDebugging(isDebugging)
+{
+    bool ok = false;
+    int threads = qEnvironmentVariableIntValue("QML_TYPELOADER_PARSE_THREADS", &ok);
+    if (!ok)
+        threads = qMin(QThread::idealThreadCount() - 1, MaximumParseThreads);
+    threads = qBound(0, threads, QThread::idealThreadCount());
+
+    // QThreadPool always runs at least one thread, no matter what we set as maximum.
+    m_isEnabled = threads > 0;
+    if (m_isEnabled)
+        m_pool.setMaxThreadCount(threads);
+}
+
+QQmlTypeLoaderParsePool::~QQmlTypeLoaderParsePool()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const std::shared_ptr<Job> &job : std::as_const(m_jobs)) {
+            if (job->state == Job::Queued)
+                job->state = Job::Cancelled;
+        }
+        m_jobs.clear();
+    }
+    m_pool.waitForDone();
+}
+
+/*!
+    \internal
+    Schedules the QML file \a fileName, to be loaded from \a url, for parsing on a worker thread.
+*/
+void QQmlTypeLoaderParsePool::parse(const QUrl &url, const QString &fileName)
+{
+    if (!m_isEnabled || fileName.isEmpty())
+        return;
+
+    auto job = std::make_shared<Job>();
+    job->url = url;
+    job->fileName = fileName;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_jobs.contains(url))
+            return;
+        m_jobs.insert(url, job);
+    }
+
+    m_pool.start([this, job]() { run(job); });
+}
+
+/*!
+    \internal
+    Returns the document parsed ahead of time for \a url, or nullptr if there is none that
+    matches \a source. If the document is still being parsed, waits for it.
+    A document that has not been picked up by a worker yet is dropped, as parsing it on the
+    calling thread is cheaper than waiting for a worker to become available.
+*/
+std::unique_ptr<QmlIR::Document> QQmlTypeLoaderParsePool::take(
+        const QUrl &url, const QString &source)
+{
+    QMutexLocker locker(&m_mutex);
+    const std::shared_ptr<Job> job = m_jobs.take(url);
+    if (!job)
+        return nullptr;
+
+    if (job->state == Job::Queued) {
+        job->state = Job::Cancelled;
+        return nullptr;
+    }
+
+    while (job->state == Job::Running)
+        m_finished.wait(&m_mutex);
+
+    // The file may have changed in between. Then we have to parse it again.
+    if (!job->document || job->source != source)
+        return nullptr;
+
+    ++m_takenDocumentCount;
+    return std::move(job->document);
+}
+
+/*!
+    \internal
+    Drops any document parsed or scheduled for \a url without waiting for it.
+*/
+void QQmlTypeLoaderParsePool::discard(const QUrl &url)
+{
+    QMutexLocker locker(&m_mutex);
+    if (const std::shared_ptr<Job> job = m_jobs.take(url))
+        job->state = Job::Cancelled;
+}
+
+/*!
+    \internal
+    Returns how many documents parsed ahead of time have been picked up by take().
+*/
+int QQmlTypeLoaderParsePool::takenDocumentCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_takenDocumentCount;
+}
+
+void QQmlTypeLoaderParsePool::run(const std::shared_ptr<Job> &job)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (job->state != Job::Queued)
+            return;
+        job->state = Job::Running;
+    }
+
+    QString source;
+    std::unique_ptr<QmlIR::Document> document;
+
+    QFile file(job->fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        source = QString::fromUtf8(file.readAll());
+        document = std::make_unique<QmlIR::Document>(m_isDebugging);
+        QmlIR::IRBuilder builder;
+
+        // Errors are reported when the type loader thread parses the file again.
+        if (!builder.generateFromQml(source, job->url.toString(), document.get()))
+            document.reset();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (job->state == Job::Running) {
+        job->source = std::move(source);
+        job->document = std::move(document);
+    }
+    job->state = Job::Finished;
+    m_finished.wakeAll();
+}
+
+QT_END_NAMESPACE
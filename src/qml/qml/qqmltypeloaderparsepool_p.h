@@ -0,0 +1,70 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QQMLTYPELOADERPARSEPOOL_P_H
+#define QQMLTYPELOADERPARSEPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQml/qtqmlglobal.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+namespace QmlIR {
+struct Document;
+}
+
+// Parses QML files ahead of time on a bounded set of worker threads.
+//
+// All state transitions of data blobs still happen on the type loader thread, in the same
+// order as before. The pool only takes the CPU heavy part of loading a QML file from source,
+// reading it and building the IR, off that thread. Once the type loader thread gets to a file
+// that has been scheduled here, it picks up the ready document instead of parsing it again.
+class QQmlTypeLoaderParsePool
+{
+    Q_DISABLE_COPY_MOVE(QQmlTypeLoaderParsePool)
+public:
+    QQmlTypeLoaderParsePool(bool isDebugging);
+    ~QQmlTypeLoaderParsePool();
+
+    bool isEnabled() const { return m_isEnabled; }
+
+    void parse(const QUrl &url, const QString &fileName);
+    std::unique_ptr<QmlIR::Document> take(const QUrl &url, const QString &source);
+    void discard(const QUrl &url);
+
+    int takenDocumentCount() const;
+
+private:
+    struct Job;
+    void run(const std::shared_ptr<Job> &job);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_finished;
+    QHash<QUrl, std::shared_ptr<Job>> m_jobs;
+    QThreadPool m_pool;
+    int m_takenDocumentCount = 0;
+    bool m_isDebugging = false;
+    bool m_isEnabled = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QQMLTYPELOADERPARSEPOOL_P_H
@@ -3,6 +3,7 @@
 
 #include <private/qqmlengine_p.h>
 #include <private/qqmlextensionplugin_p.h>
+#include <private/qqmltypeloaderparsepool_p.h>
 #include <private/qqmltypeloaderthread_p.h>
 
 #if QT_CONFIG(qml_network)
@@ -21,6 +22,17 @@ QQmlTypeLoaderThread::QQmlTypeLoaderThread(QQmlTypeLoader *loader)
 QQmlTypeLoaderThread::~QQmlTypeLoaderThread()
 {
     shutdown();
+
+    // Only after the thread is gone, nobody can schedule new parse jobs anymore.
+    m_parsePool.reset();
+}
+
+QQmlTypeLoaderParsePool *QQmlTypeLoaderThread::parsePool() const
+{
+    Q_ASSERT(isThisThread());
+    if (!m_parsePool)
+        m_parsePool = std::make_unique<QQmlTypeLoaderParsePool>(m_loader->m_isDebugging);
+    return m_parsePool.get();
 }
 
 #if QT_CONFIG(qml_network)
@@ -21,6 +21,8 @@
 
 #include <QtQml/qtqmlglobal.h>
 
+#include <memory>
+
 #if QT_CONFIG(qml_network)
 #include <private/qqmltypeloadernetworkreplyproxy_p.h>
 #include <QtNetwork/qnetworkaccessmanager.h>
@@ -31,6 +33,7 @@ QT_BEGIN_NAMESPACE
 class QQmlTypeLoader;
 class QQmlEngineExtensionInterface;
 class QQmlExtensionInterface;
+class QQmlTypeLoaderParsePool;
 
 namespace QQmlPrivate {
 struct CachedQmlUnit;
@@ -47,6 +50,7 @@ public:
     QNetworkAccessManager *networkAccessManager() const;
     QQmlTypeLoaderNetworkReplyProxy *networkReplyProxy() const;
 #endif // qml_network
+    QQmlTypeLoaderParsePool *parsePool() const;
     void load(const QQmlDataBlob::Ptr &b);
     void loadAsync(const QQmlDataBlob::Ptr &b);
     void loadWithStaticData(const QQmlDataBlob::Ptr &b, const QByteArray &);
@@ -70,6 +74,7 @@ private:
     void dropThread(const QQmlDataBlob::Ptr &b);
 
     QQmlTypeLoader *m_loader;
+    mutable std::unique_ptr<QQmlTypeLoaderParsePool> m_parsePool;
 #if QT_CONFIG(qml_network)
     mutable QNetworkAccessManager *m_networkAccessManager = nullptr;
     mutable QQmlTypeLoaderNetworkReplyProxy *m_networkReplyProxy = nullptr;
@@ -31,13 +31,17 @@
 #include <QtGui/qmatrix4x4.h>
 #include <QtGui/private/qevent_p.h>
 #include <QtGui/private/qpointingdevice_p.h>
+#include <QtGui/qscreen.h>
 #include <QtCore/qvarlengtharray.h>
 #include <QtCore/qabstractanimation.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QRunnable>
 #include <QtQml/qqmlincubator.h>
 #include <QtQml/qqmlinfo.h>
 #include <QtQml/private/qqmlmetatype_p.h>
+#include <QtQml/private/qv4engine_p.h>
+#include <QtQml/private/qv4mm_p.h>
 
 #include <QtQuick/private/qquickpixmap_p.h>
 
@@ -77,11 +81,15 @@ class QQuickWindowIncubationController : public QObject, public QQmlIncubationCo
     Q_OBJECT
 
 public:
-    QQuickWindowIncubationController(QSGRenderLoop *loop)
-        : m_renderLoop(loop), m_timer(0)
+    QQuickWindowIncubationController(QQuickWindow *window, QSGRenderLoop *loop)
+        : m_window(window), m_renderLoop(loop), m_timer(0)
     {
-        // Allow incubation for 1/3 of a frame.
-        m_incubation_time = qMax(1, int(1000 / QGuiApplication::primaryScreen()->refreshRate()) / 3);
+        updateFrameInterval();
+        connect(window, &QWindow::screenChanged,
+                this, &QQuickWindowIncubationController::updateFrameInterval);
+
+        // Animations are advanced first thing in a frame on the GUI thread.
+        connect(window, &QQuickWindow::afterAnimating, this, [this]() { m_frameStart.start(); });
 
         QAnimationDriver *animationDriver = m_renderLoop->animationDriver();
         if (animationDriver) {
@@ -108,19 +116,59 @@ protected:
 
 public slots:
     void incubate() {
-        if (m_renderLoop && incubatingObjectCount()) {
-            if (m_renderLoop->interleaveIncubation()) {
-                incubateFor(m_incubation_time);
-            } else {
-                incubateFor(m_incubation_time * 2);
-                if (incubatingObjectCount())
-                    incubateAgain();
-            }
+        if (m_renderLoop && m_renderLoop->interleaveIncubation()) {
+            // When interleaving, we get called right after a frame was synced. Use the first
+            // half of what remains of the frame for incubation and the second one for the gc.
+            const int remaining = remainingFrameTime();
+            const QDeadlineTimer gcDeadline(remaining);
+            if (incubatingObjectCount())
+                incubateFor(qMax(1, remaining / 2));
+            runGCInIdleTime(gcDeadline);
+        } else if (m_renderLoop && incubatingObjectCount()) {
+            incubateFor(m_incubation_time * 2);
+            if (incubatingObjectCount())
+                incubateAgain();
         }
     }
 
     void animationStopped() { incubate(); }
 
+private slots:
+    void updateFrameInterval()
+    {
+        const QScreen *screen = m_window ? m_window->screen() : nullptr;
+        if (!screen)
+            screen = QGuiApplication::primaryScreen();
+        const qreal refreshRate = screen ? screen->refreshRate() : 60;
+        m_frameInterval = qMax(1, int(1000 / (refreshRate > 0 ? refreshRate : 60)));
+
+        // Allow incubation for 1/3 of a frame when we don't know where in the frame we are.
+        m_incubation_time = qMax(1, m_frameInterval / 3);
+    }
+
+private:
+    int remainingFrameTime() const
+    {
+        // Leave a sixth of the frame for handling events and polishing the next frame.
+        const int usableTime = m_frameInterval - m_frameInterval / 6;
+        // We also get called for frames of other windows, and after our window
+        // stopped rendering. Our own frame start is of no use then.
+        if (!m_frameStart.isValid() || m_frameStart.elapsed() > m_frameInterval)
+            return m_incubation_time * 2;
+        return qBound(1, usableTime - int(m_frameStart.elapsed()), usableTime);
+    }
+
+    void runGCInIdleTime(QDeadlineTimer deadline)
+    {
+        QQmlEngine *qmlEngine = engine();
+        if (!qmlEngine)
+            return;
+        // Keep the gc from running in the middle of the next frame. We expect to
+        // be called again one frame later, otherwise the gc continues on its own.
+        qmlEngine->handle()->memoryManager->runGCInIdleTime(
+                deadline, QDeadlineTimer(m_incubation_time * 4));
+    }
+
 protected:
     void incubatingObjectCountChanged(int count) override
     {
@@ -129,7 +177,10 @@ protected:
     }
 
 private:
+    QPointer<QQuickWindow> m_window;
     QPointer<QSGRenderLoop> m_renderLoop;
+    QElapsedTimer m_frameStart;
+    int m_frameInterval;
     int m_incubation_time;
     int m_timer;
 };
@@ -2721,7 +2772,8 @@ QQmlIncubationController *QQuickWindow::incubationController() const
         return nullptr; // TODO: make sure that this is safe
 
     if (!d->incubationController)
-        d->incubationController = new QQuickWindowIncubationController(d->windowManager);
+        d->incubationController = new QQuickWindowIncubationController(
+                const_cast<QQuickWindow *>(this), d->windowManager);
     return d->incubationController;
 }
 
@@ -20,6 +20,8 @@
 #include <QtQml/qqmllist.h>
 #include <QtQuickTestUtils/private/qmlutils_p.h>
 #include <private/qv4functionobject_p.h>
+#include <private/qv4lookup_p.h>
+#include <private/qv4regexp_p.h>
 
 #ifdef Q_CC_MSVC
 #define NO_INLINE __declspec(noinline)
@@ -142,12 +144,22 @@ private slots:
     void reentrancy_objectCreation();
     void jsIncDecNonObjectProperty();
     void JSON_Parse();
+    void JSON_Parse_sameShapes();
     void JSON_Stringify_data();
     void JSON_Stringify();
     void JSON_Stringify_WithReplacer_QTBUG_95324();
     void arraySort();
     void lookupOnDisappearingProperty();
+    void polymorphicLookup();
+    void lookupStatistics();
     void arrayConcat();
+    void arrayStoreElement_data();
+    void arrayStoreElement();
+    void stringAppend();
+    void preallocatedMembers();
+    void regExpCacheKeepsRecentPatterns();
+    void externalArrayBuffer();
+    void typedArrayBulkOperations();
     void recursiveBoundFunctions();
 
     void qRegularExpressionImport_data();
@@ -333,6 +345,8 @@ private slots:
 
     void setDeleteDuringForEach();
     void mapDeleteDuringForEach();
+    void mapDeleteAndSetDuringForOf();
+    void mapWithQObjectKeys();
 
     void multiMatchingRegularExpression();
 
@@ -3470,6 +3484,37 @@ void tst_QJSEngine::JSON_Parse()
     QVERIFY(ret.isObject());
 }
 
+void tst_QJSEngine::JSON_Parse_sameShapes()
+{
+    // Objects on the same level start out with the shape of their predecessor.
+    // Make sure that deviating keys are handled correctly.
+    QJSEngine eng;
+    QJSValue parsed = eng.evaluate(R"(
+        JSON.parse('[{"a":1,"b":"x"},{"a":2,"b":"y"},{"a":3},{"a":4,"b":"z","c":true},'
+                   + '{"b":5,"a":6},{"a":7,"a":8},{"a":9,"0":10},{"a":{"n":[1,{"n":2}]},"b":null},'
+                   + '{"a":"\\"q\\" \\\\ \\u0041\\u0001\\n","b":"long enough for several chunks"}]');
+    )");
+    QVERIFY(parsed.isArray());
+    QCOMPARE(parsed.property("length").toInt(), 9);
+    QCOMPARE(parsed.property(1).property("b").toString(), u"y"_s);
+    QVERIFY(!parsed.property(2).hasOwnProperty(u"b"_s));
+    QCOMPARE(parsed.property(3).property("c").toBool(), true);
+    QCOMPARE(parsed.property(4).property("a").toInt(), 6);
+    QCOMPARE(parsed.property(5).property("a").toInt(), 8);
+    QCOMPARE(parsed.property(8).property("a").toString(), u"\"q\" \\ A\x01\n"_s);
+
+    QJSValue stringify = eng.evaluate("(function(obj, gap) { return JSON.stringify(obj, null, gap); })");
+    QCOMPARE(stringify.call({ parsed }).toString(),
+             uR"([{"a":1,"b":"x"},{"a":2,"b":"y"},{"a":3},{"a":4,"b":"z","c":true},)"
+             uR"({"b":5,"a":6},{"a":8},{"0":10,"a":9},{"a":{"n":[1,{"n":2}]},"b":null},)"
+             uR"({"a":"\"q\" \\ A\u0001\n","b":"long enough for several chunks"}])"_s);
+
+    // Members without a JSON representation are left out, including their separators.
+    QJSValue object = eng.evaluate("({ a: undefined, b: 1, c: function() {}, d: [undefined, 2], e: {} })");
+    QCOMPARE(stringify.call({ object, 2 }).toString(),
+             u"{\n  \"b\": 1,\n  \"d\": [\n    null,\n    2\n  ],\n  \"e\": {}\n}"_s);
+}
+
 void tst_QJSEngine::JSON_Stringify_data()
 {
     QTest::addColumn<QString>("object");
@@ -3556,6 +3601,104 @@ void tst_QJSEngine::lookupOnDisappearingProperty()
     QVERIFY(func.call(QJSValueList()<< o).isUndefined());
 }
 
+void tst_QJSEngine::polymorphicLookup()
+{
+    QJSEngine eng;
+    eng.installExtensions(QJSEngine::GarbageCollectionExtension);
+    QJSValue result = eng.evaluate(R"(
+        function read(o) { return o.value; }
+        function shape(i) {
+            var o = {};
+            // Vary the order and number of properties so that we get many internal classes,
+            // with the value both in inline storage and in member data.
+            for (var j = 0; j < i; ++j)
+                o["p" + j] = j;
+            o.value = i;
+            return o;
+        }
+
+        var objects = [];
+        for (var i = 0; i < 12; ++i)
+            objects.push(shape(i * 3));
+        objects.push(Object.create({ value: 100 }));
+        objects.push({ get value() { return 200; } });
+        objects.push("string");
+
+        var sum = 0;
+        for (var k = 0; k < 3; ++k) {
+            for (var i = 0; i < objects.length; ++i) {
+                var v = read(objects[i]);
+                sum += (v === undefined) ? 1000 : v;
+            }
+            gc();
+            objects[0].value = 7;
+            delete objects[1].value;
+        }
+        sum;
+    )");
+    QVERIFY(!result.isError());
+    // 3 * (3 * (0 + 1 + ... + 11) + 100 + 200 + 1000), with the changes after the first round
+    QCOMPARE(result.toInt(), 3 * (198 + 1300) + 2 * (7 - 3 + 1000));
+}
+
+void tst_QJSEngine::lookupStatistics()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.qml.lookup.statistics.debug=true"));
+    const auto guard = qScopeGuard([]() { QLoggingCategory::setFilterRules(QString()); });
+
+    QJSEngine eng;
+    const QV4::LookupStatistics *stats = eng.handle()->lookupStatistics;
+    QVERIFY(stats);
+
+    QJSValue result = eng.evaluate(R"(
+        function read(o) { return o.value; }
+        var sum = 0;
+        for (var i = 0; i < 10; ++i)
+            sum += read(new Proxy({ value: i }, {}));
+        sum;
+    )");
+    QCOMPARE(result.toInt(), 45);
+
+    // Proxies always take the fallback path
+    const QList<QV4::LookupStatistics::Site> sites = stats->sitesBySlowPathCount();
+    QVERIFY(!sites.isEmpty());
+    QCOMPARE(sites.first().name, QStringLiteral("value"));
+    QCOMPARE(sites.first().line, 2);
+    QCOMPARE(sites.first().call, QV4::Lookup::Call::GetterQObjectPropertyFallback);
+    QVERIFY(sites.first().slowPathCount >= 10);
+    QVERIFY(stats->slowPathCounts.value(QV4::Lookup::Call::GetterQObjectPropertyFallback) >= 10);
+
+    // Resolving a lookup for the first time is not a slow path
+    QCOMPARE(stats->slowPathCounts.value(QV4::Lookup::Call::GetterGeneric), 0u);
+    QCOMPARE(stats->slowPathCounts.value(QV4::Lookup::Call::GlobalGetterGeneric), 0u);
+
+    // Accesses to megamorphic lookups count, even if they hit the engine wide cache
+    result = eng.evaluate(R"(
+        function readX(o) { return o.x; }
+        var objects = [];
+        for (var i = 0; i < 20; ++i) {
+            var o = {};
+            o["p" + i] = i;
+            o.x = 1;
+            objects.push(o);
+        }
+        var count = 0;
+        for (var j = 0; j < 10; ++j) {
+            for (var k = 0; k < objects.length; ++k)
+                count += readX(objects[k]);
+        }
+        count;
+    )");
+    QCOMPARE(result.toInt(), 200);
+
+    const QList<QV4::LookupStatistics::Site> megamorphicSites = stats->sitesBySlowPathCount();
+    QVERIFY(!megamorphicSites.isEmpty());
+    QCOMPARE(megamorphicSites.first().name, QStringLiteral("x"));
+    QCOMPARE(megamorphicSites.first().line, 2);
+    QCOMPARE(megamorphicSites.first().call, QV4::Lookup::Call::GetterMegamorphic);
+    QVERIFY(megamorphicSites.first().slowPathCount >= 150);
+}
+
 void tst_QJSEngine::arrayConcat()
 {
     QJSEngine eng;
@@ -3569,6 +3712,275 @@ void tst_QJSEngine::arrayConcat()
     QCOMPARE(v.toString(), QString::fromLatin1("6,10,11,12"));
 }
 
+void tst_QJSEngine::arrayStoreElement_data()
+{
+    QTest::addColumn<QString>("setup");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("append") << QString() << u"0,1,2,3,4,5,6,7,8,9|10"_s;
+    QTest::newRow("double index") << u"i = i / 2 * 2;"_s << u"0,1,2,3,4,5,6,7,8,9|10"_s;
+    QTest::newRow("frozen") << u"if (i == 5) Object.freeze(a);"_s << u"0,1,2,3,4|5"_s;
+    QTest::newRow("readonly length")
+            << u"if (i == 5) Object.defineProperty(a, 'length', { writable: false });"_s
+            << u"0,1,2,3,4|5"_s;
+    QTest::newRow("setter in prototype")
+            << u"if (i == 5) Object.defineProperty(Array.prototype, '7', { set: function(v) { "
+               "Object.defineProperty(this, '7', { value: -v, writable: true, enumerable: true, "
+               "configurable: true }); } });"_s
+            << u"0,1,2,3,4,5,6,-7,8,9|10"_s;
+    QTest::newRow("string prototype")
+            << u"if (i == 5) Object.setPrototypeOf(a, new String('0123456789'));"_s
+            << u"0,1,2,3,4|5"_s;
+    QTest::newRow("longer length") << u"if (i == 5) a.length = 7;"_s
+                                   << u"0,1,2,3,4,,,5,6,7,8,9|12"_s;
+}
+
+void tst_QJSEngine::arrayStoreElement()
+{
+    QFETCH(QString, setup);
+    QFETCH(QString, expected);
+
+    QJSEngine eng;
+    const QJSValue result = eng.evaluate(uR"(
+        (function() {
+            "use strict";
+            var a = [];
+            for (var i = 0; i < 10; ++i) {
+                %1
+                try {
+                    if (a.length === i)
+                        a[i] = i;
+                    else
+                        a[a.length] = i;
+                } catch (e) {}
+            }
+            return a.join(",") + "|" + a.length;
+        })()
+    )"_s.arg(setup));
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.toString(), expected);
+}
+
+void tst_QJSEngine::stringAppend()
+{
+    // Long strings that are built piece by piece get appended to in place.
+    // Earlier versions of the string have to keep their contents.
+    QJSEngine eng;
+    eng.installExtensions(QJSEngine::GarbageCollectionExtension);
+    QJSValue result = eng.evaluate(R"(
+        (function() {
+            var pieces = [];
+            var versions = [];
+            var s = "";
+            for (var i = 0; i < 3000; ++i) {
+                var piece = "line " + i + ";";
+                pieces.push(piece);
+                s += piece;
+                if (i % 100 == 0) {
+                    versions.push([s, i]);
+                    // Force the string to be flat.
+                    if (s.indexOf("#") !== -1)
+                        return "unexpected #";
+                }
+                if (i % 250 == 0) {
+                    var o = {};
+                    o[s] = i; // turn it into an identifier
+                }
+                if (i % 1000 == 0)
+                    gc();
+            }
+
+            var a = s + "a";
+            var b = s + "b";
+            if (a.length !== b.length || a[a.length - 1] !== "a" || b[b.length - 1] !== "b")
+                return "branched appends differ";
+            if (s + s !== a.slice(0, -1) + s)
+                return "appending to itself failed";
+
+            // Earlier versions refer to later ones. The gc shortens those chains.
+            gc();
+            for (var j = 0; j < versions.length; ++j) {
+                var version = versions[j];
+                if (version[0] !== pieces.slice(0, version[1] + 1).join(""))
+                    return "version " + version[1] + " was modified";
+            }
+            var tail = s.substring(s.length - 10);
+            return s === pieces.join("") ? tail : "final string is wrong";
+        })()
+    )");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.toString(), u"line 2999;"_s);
+
+    // Buffers shared with a QString are not appended to.
+    eng.evaluate(u"var s = ''; for (var i = 0; i < 1000; ++i) s += 'line ' + i + ';'; s.indexOf('#')"_s);
+    const QString shared = eng.globalObject().property(u"s"_s).toString();
+    const qsizetype sharedLength = shared.size();
+    QCOMPARE(eng.evaluate(u"s += 'tail'; s.length"_s).toInt(), sharedLength + 4);
+    QCOMPARE(shared.size(), sharedLength);
+    QCOMPARE(shared.utf16()[sharedLength], u'\0');
+    QVERIFY(shared.endsWith(u"line 999;"_s));
+}
+
+void tst_QJSEngine::preallocatedMembers()
+{
+    // Object literals with members beyond their precomputed class, and objects
+    // created by constructors, get room for their members up front.
+    QJSEngine eng;
+    QJSValue result = eng.evaluate(R"(
+        (function() {
+            var key = "computed";
+            var out = [];
+            for (var i = 0; i < 3; ++i) {
+                var hidden = i;
+                var o = {
+                    a: i, b: i + 1, c: i + 2, d: i + 3, e: i + 4,
+                    [key]: "x" + i,
+                    get g() { return hidden; },
+                    set g(v) { hidden = v; },
+                    m() { return this.a + this.e; },
+                    f: 10 + i,
+                };
+                o.g = o.g + 100;
+                out.push([o.a, o.e, o.computed, o.g, o.m(), o.f, Object.keys(o).join("")].join(" "));
+            }
+
+            function Point(n) {
+                for (var j = 0; j < n; ++j)
+                    this["p" + j] = j;
+                this.last = n;
+            }
+            // Construct instances of growing and shrinking size.
+            var sizes = [2, 12, 30, 5, 40];
+            for (var k = 0; k < sizes.length; ++k) {
+                var p = new Point(sizes[k]);
+                out.push(Object.keys(p).length + ":" + p["p" + (sizes[k] - 1)] + ":" + p.last);
+            }
+            return out.join("|");
+        })()
+    )");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.toString(),
+             u"0 4 x0 100 4 10 abcdecomputedgmf|"
+             "1 5 x1 101 6 11 abcdecomputedgmf|"
+             "2 6 x2 102 8 12 abcdecomputedgmf|"
+             "3:1:2|13:11:12|31:29:30|6:4:5|41:39:40"_s);
+}
+
+void tst_QJSEngine::regExpCacheKeepsRecentPatterns()
+{
+    // Patterns created from strings survive garbage collection, together with
+    // their compiled code, as long as they were used recently.
+    QJSEngine eng;
+    const QString pattern = u"^[a-z]+@[a-z]+[.]com$"_s;
+    QJSValue validate = eng.evaluate(
+            u"(function(s) { return new RegExp('%1', 'i').test(s); })"_s.arg(pattern));
+    QVERIFY(validate.isCallable());
+    QVERIFY(validate.call({ u"Joe@Example.com"_s }).toBool());
+
+    eng.collectGarbage();
+
+    QV4::RegExpCache *cache = eng.handle()->regExpCache;
+    QVERIFY(cache);
+    const auto it = cache->constFind(
+            QV4::RegExpCacheKey(pattern, QV4::CompiledData::RegExp::RegExp_IgnoreCase));
+    QVERIFY(it != cache->constEnd());
+    QVERIFY(!it->isNullOrUndefined());
+
+    QVERIFY(validate.call({ u"joe@example.com"_s }).toBool());
+    QVERIFY(!validate.call({ u"joe@example"_s }).toBool());
+}
+
+void tst_QJSEngine::externalArrayBuffer()
+{
+    // ArrayBuffers can wrap memory owned by someone else without copying it.
+    // The memory is copied when written to, and released after that.
+    static const char samples[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    bool released = false;
+
+    QJSEngine engine;
+    QV4::Scope scope(engine.handle());
+    QV4::ScopedValue buffer(scope, scope.engine->newArrayBuffer(
+                                           samples, sizeof(samples), [&released]() { released = true; }));
+    engine.globalObject().setProperty(
+            u"samples"_s, QJSValuePrivate::fromReturnedValue(buffer->asReturnedValue()));
+
+    QCOMPARE(engine.evaluate(u"new Uint8Array(samples).reduce((a, b) => a + b, 0)"_s).toInt(), 36);
+    QVERIFY(!released);
+
+    QCOMPARE(engine.evaluate(u"(function() { var a = new Uint8Array(samples); a[0] = 100;"
+                             "return new Uint8Array(samples)[0] + a[7]; })()"_s).toInt(), 108);
+    QCOMPARE(samples[0], 1);
+    QVERIFY(released);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(samples, sizeof(samples)), qint64(sizeof(samples)));
+    file.close();
+
+    QV4::ScopedValue mapped(scope, scope.engine->newArrayBufferFromFile(file.fileName()));
+    QVERIFY(mapped->isObject());
+    engine.globalObject().setProperty(
+            u"mapped"_s, QJSValuePrivate::fromReturnedValue(mapped->asReturnedValue()));
+    QCOMPARE(engine.evaluate(u"new DataView(mapped).getUint32(4, true)"_s).toUInt(), 0x08070605U);
+
+    QVERIFY(!scope.engine->newArrayBufferFromFile(file.fileName() + u".missing"_s));
+
+    // The length of an ArrayBuffer has to fit into a uint.
+    released = false;
+    QVERIFY(!scope.engine->newArrayBuffer(samples, size_t(UINT_MAX), [&released]() { released = true; }));
+    QVERIFY(released);
+}
+
+void tst_QJSEngine::typedArrayBulkOperations()
+{
+    QJSEngine engine;
+    QJSValue result = engine.evaluate(R"(
+        (function() {
+            var out = [];
+
+            var f = new Float64Array([3, NaN, -0, 1.5, 0, -Infinity, NaN, 2]);
+            f.sort();
+            out.push(Array.from(f, function(x) { return Object.is(x, -0) ? "-0" : String(x); }).join(","));
+            out.push(f.indexOf(NaN), f.includes(NaN), f.indexOf(0), f.lastIndexOf(-0), f.indexOf("2"));
+
+            var i8 = new Int8Array([5, -3, 100, 0, -128, 127]);
+            out.push(i8.sort().join(","), i8.indexOf(0.5), i8.indexOf(300), i8.indexOf(-128));
+            out.push(i8.sort(function(a, b) { return b - a; }).join(","));
+
+            var c = new Uint8ClampedArray(6).fill(300, 1, 4);
+            out.push(c.join(","), c.lastIndexOf(255), c.includes(300));
+
+            var u = new Uint32Array([1, 2, 3, 4, 4294967295]);
+            var s = u.slice(1, 4);
+            s[0] = 42;
+            out.push(s.join(","), u[1], u.indexOf(4294967295), u[7], u[-1]);
+
+            var f32 = new Float32Array(4);
+            for (var k = 0; k < 6; ++k)
+                f32[k] = k + 0.25;
+            out.push(f32.join(","), f32.length, f32.indexOf(1e300), f32.includes(-1e300));
+
+            var base = new Uint8Array([1, 2, 3, 4, 5, 6, 7, 8]);
+            var view = new Uint8Array(base.buffer, 0, 6);
+            view.constructor = {};
+            view.constructor[Symbol.species] = function(n) {
+                return new Uint8Array(base.buffer, 2, n);
+            };
+            view.slice(0, 4);
+            out.push(base.join(","));
+            return out.join("|");
+        })()
+    )");
+    QVERIFY2(!result.isError(), qPrintable(result.toString()));
+    QCOMPARE(result.toString(),
+             u"-Infinity,-0,0,1.5,2,3,NaN,NaN|-1|true|1|2|-1|"
+             "-128,-3,0,5,100,127|-1|-1|0|127,100,5,0,-3,-128|"
+             "0,255,255,255,0,0|3|false|"
+             "42,3,4|2|4|undefined|undefined|"
+             "0.25,1.25,2.25,3.25|4|-1|false|"
+             "1,2,1,2,1,2,7,8"_s);
+}
+
 void tst_QJSEngine::recursiveBoundFunctions()
 {
 
@@ -6614,6 +7026,60 @@ void tst_QJSEngine::mapDeleteDuringForEach() {
   QCOMPARE(visited, QJsonArray({1, 2, 3}));
 }
 
+void tst_QJSEngine::mapDeleteAndSetDuringForOf() {
+  QJSEngine engine;
+  QJSValue result = engine.evaluate(R"(
+    let map = new Map([[1, 1], [2, 2], [3, 3], [4, 4]]);
+    let visited = []
+    for (const [k, v] of map) {
+        visited.push(v);
+        if (k === 3) {
+            map.delete(1);
+            map.delete(2);
+            for (let i = 5; i <= 9; ++i)
+                map.set(i, i);
+        }
+    }
+    visited
+  )");
+
+  QVERIFY(result.isArray());
+
+  QJsonArray visited = engine.fromScriptValue<QJsonArray>(result);
+  QCOMPARE(visited, QJsonArray({1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+void tst_QJSEngine::mapWithQObjectKeys()
+{
+    QJSEngine engine;
+    std::vector<std::unique_ptr<QObject>> objects;
+    QJSValue array = engine.newArray(100);
+    for (int i = 0; i < 100; ++i) {
+        objects.push_back(std::make_unique<QObject>());
+        QJSEngine::setObjectOwnership(objects.back().get(), QJSEngine::CppOwnership);
+        array.setProperty(i, engine.newQObject(objects.back().get()));
+    }
+    engine.globalObject().setProperty("objects", array);
+
+    QJSValue result = engine.evaluate(R"(
+        let map = new Map;
+        for (let i = 0; i < objects.length; ++i)
+            map.set(objects[i], i);
+        let found = 0;
+        for (let i = 0; i < objects.length; ++i) {
+            if (map.get(objects[i]) === i)
+                ++found;
+        }
+        found + map.size
+    )");
+    QCOMPARE(result.toInt(), 200);
+
+    // Wrappers of deleted objects are still found.
+    objects[42].reset();
+    result = engine.evaluate("map.has(objects[42]) && map.size === 100");
+    QVERIFY(result.toBool());
+}
+
 void tst_QJSEngine::multiMatchingRegularExpression()
 {
     QJSEngine engine;
@@ -47,6 +47,7 @@ private slots:
     void garbageCollection();
     void requiredProperties();
     void deleteInSetInitialState();
+    void priority();
 
 private:
     QQmlIncubationController controller;
@@ -1246,6 +1247,78 @@ void tst_qqmlincubator::deleteInSetInitialState()
     QCOMPARE(incubator.object(), nullptr); // object was deleted
 }
 
+void tst_qqmlincubator::priority()
+{
+    class OrderIncubator : public QQmlIncubator
+    {
+    public:
+        OrderIncubator(QList<QQmlIncubator::Priority> *order, Priority priority)
+            : order(order)
+        {
+            setPriority(priority);
+        }
+
+    protected:
+        void statusChanged(Status s) override
+        {
+            if (s == Ready)
+                *order << priority();
+        }
+
+    private:
+        QList<QQmlIncubator::Priority> *order;
+    };
+
+    QQmlComponent component(&engine, testFileUrl("statusChanged.qml"));
+    QVERIFY(component.isReady());
+
+    {
+    QList<QQmlIncubator::Priority> order;
+    OrderIncubator low(&order, QQmlIncubator::LowPriority);
+    OrderIncubator high(&order, QQmlIncubator::HighPriority);
+    OrderIncubator normal(&order, QQmlIncubator::NormalPriority);
+    component.create(low);
+    component.create(high);
+    component.create(normal);
+    QVERIFY(low.isLoading());
+    QVERIFY(high.isLoading());
+    QVERIFY(normal.isLoading());
+
+    {
+    std::atomic<bool> b{true};
+    controller.incubateWhile(&b);
+    }
+
+    QCOMPARE(order, (QList<QQmlIncubator::Priority>{
+            QQmlIncubator::HighPriority, QQmlIncubator::NormalPriority,
+            QQmlIncubator::LowPriority }));
+    delete low.object();
+    delete high.object();
+    delete normal.object();
+    }
+
+    {
+    // Raising the priority after the incubation started takes precedence
+    // over the incubator that was started last.
+    QList<QQmlIncubator::Priority> order;
+    OrderIncubator first(&order, QQmlIncubator::NormalPriority);
+    OrderIncubator second(&order, QQmlIncubator::NormalPriority);
+    component.create(first);
+    component.create(second);
+    first.setPriority(QQmlIncubator::HighPriority);
+
+    {
+    std::atomic<bool> b{true};
+    controller.incubateWhile(&b);
+    }
+
+    QCOMPARE(order, (QList<QQmlIncubator::Priority>{
+            QQmlIncubator::HighPriority, QQmlIncubator::NormalPriority }));
+    delete first.object();
+    delete second.object();
+    }
+}
+
 QTEST_MAIN(tst_qqmlincubator)
 
 #include "tst_qqmlincubator.moc"
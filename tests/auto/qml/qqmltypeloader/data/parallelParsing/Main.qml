@@ -0,0 +1,8 @@
+import QtQml
+
+QtObject {
+    property QtObject a: First {}
+    property QtObject b: Second {}
+    property QtObject c: Third {}
+    property int sum: a.value + b.value + c.value
+}
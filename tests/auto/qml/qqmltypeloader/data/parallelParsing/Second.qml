@@ -0,0 +1,6 @@
+import QtQml
+
+QtObject {
+    property First first: First {}
+    property int value: first.value + 1
+}
@@ -0,0 +1,6 @@
+import QtQml
+
+QtObject {
+    property QtObject a: First {}
+    property QtObject b: Broken {}
+}
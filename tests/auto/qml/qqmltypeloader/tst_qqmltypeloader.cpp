@@ -13,6 +13,7 @@
 #include <QtQml/private/qqmlengine_p.h>
 #include <QtQml/private/qqmltypedata_p.h>
 #include <QtQml/private/qqmltypeloader_p.h>
+#include <QtQml/private/qqmltypeloaderparsepool_p.h>
 #include <QtQml/private/qqmlirbuilder_p.h>
 #include <QtQml/private/qqmlirloader_p.h>
 #include <QtQuickTestUtils/private/testhttpserver_p.h>
@@ -51,6 +52,8 @@ private slots:
     void signalHandlersAreCompatible();
     void loadTypeOnShutdown();
     void floodTypeLoaderEventQueue();
+    void parallelParsing();
+    void preloadImports();
 
 private:
     void checkSingleton(const QString & dataDirectory);
@@ -865,6 +868,75 @@ void tst_QQMLTypeLoader::floodTypeLoaderEventQueue()
     }
 }
 
+void tst_QQMLTypeLoader::parallelParsing()
+{
+#if QT_CONFIG(process) && !defined(Q_OS_ANDROID)
+    // Files with a disk cache are not parsed ahead of time. Whether the disk cache is
+    // used is only determined once per process, so disable it in a child process.
+    const char *childKey = "QT_TST_QQMLTYPELOADER_PARALLEL_PARSING";
+    if (!qEnvironmentVariableIsSet(childKey)) {
+        QProcess child;
+        child.setProgram(QCoreApplication::applicationFilePath());
+        child.setArguments(QStringList(QLatin1String("parallelParsing")));
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert(QLatin1String(childKey), QLatin1String("1"));
+        env.insert(QLatin1String("QML_DISABLE_DISK_CACHE"), QLatin1String("1"));
+        child.setProcessEnvironment(env);
+        child.start();
+        QVERIFY(child.waitForFinished());
+        QCOMPARE(child.exitCode(), 0);
+        return;
+    }
+#endif
+
+    qputenv("QML_TYPELOADER_PARSE_THREADS", "2");
+    const auto cleanup = qScopeGuard([]() { qunsetenv("QML_TYPELOADER_PARSE_THREADS"); });
+
+    {
+        QQmlEngine engine;
+        QQmlComponent component(&engine, testFileUrl("parallelParsing/Main.qml"));
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+        QScopedPointer<QObject> root(component.create());
+        QVERIFY(!root.isNull());
+        QCOMPARE(root->property("sum").toInt(), 6);
+#if QT_CONFIG(process) && !defined(Q_OS_ANDROID)
+        // Without a disk cache, at least one of the referenced files has been parsed ahead
+        // of time.
+        QVERIFY(QQmlEnginePrivate::get(&engine)->typeLoader.parsePool()->takenDocumentCount() > 0);
+#endif
+    }
+
+    {
+        // Errors in files parsed ahead of time are reported as usual.
+        QQmlEngine engine;
+        QQmlComponent component(&engine, testFileUrl("parallelParsing/WithError.qml"));
+        QVERIFY(component.isError());
+        const QList<QQmlError> errors = component.errors();
+        QVERIFY(!errors.isEmpty());
+        QVERIFY(std::any_of(errors.begin(), errors.end(), [&](const QQmlError &error) {
+            return error.url() == testFileUrl("parallelParsing/Broken.qml");
+        }));
+    }
+}
+
+void tst_QQMLTypeLoader::preloadImports()
+{
+    QQmlEngine engine;
+    QQmlTypeLoader &loader = QQmlEnginePrivate::get(&engine)->typeLoader;
+    loader.preloadImports({ QStringLiteral("QtQuick"), QStringLiteral("Does.Not.Exist") });
+
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick\nItem { width: 10 }", QUrl());
+    QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+    QScopedPointer<QObject> root(component.create());
+    QVERIFY(!root.isNull());
+    QCOMPARE(root->property("width").toReal(), 10.0);
+
+    QQmlComponent broken(&engine);
+    broken.setData("import Does.Not.Exist\nItem {}", QUrl());
+    QVERIFY(broken.isError());
+}
+
 QTEST_MAIN(tst_QQMLTypeLoader)
 
 #include "tst_qqmltypeloader.moc"
@@ -7,15 +7,20 @@
 #endif
 #include <QtCore/qtemporaryfile.h>
 #include <QtQml/qqml.h>
+#include <QtQml/qjsengine.h>
 #include <QtQml/qqmlapplicationengine.h>
 #include <QtQuickTestUtils/private/qmlutils_p.h>
 
 #include <private/qv4global_p.h>
+#include <private/qjsvalue_p.h>
+#include <private/qv4functionobject_p.h>
 
 #ifdef Q_OS_WIN
 #include <qt_windows.h>
 #endif
 
+using namespace Qt::StringLiterals;
+
 class tst_QV4Assembler : public QQmlDataTest
 {
     Q_OBJECT
@@ -28,6 +33,10 @@ private slots:
     void perfMapFile();
     void functionTable();
     void jitEnabled();
+    void numberArithmetic_data();
+    void numberArithmetic();
+    void onStackReplacement_data();
+    void onStackReplacement();
 };
 
 tst_QV4Assembler::tst_QV4Assembler()
@@ -143,6 +152,94 @@ void tst_QV4Assembler::jitEnabled()
 #endif
 }
 
+void tst_QV4Assembler::numberArithmetic_data()
+{
+    QTest::addColumn<QString>("lhs");
+    QTest::addColumn<QString>("op");
+    QTest::addColumn<QString>("rhs");
+    QTest::addColumn<QString>("expected");
+
+    QTest::addRow("int + int") << u"1"_s << u"+"_s << u"2"_s << u"3"_s;
+    QTest::addRow("int overflow") << u"2147483647"_s << u"+"_s << u"1"_s << u"2147483648"_s;
+    QTest::addRow("double + int") << u"0.5"_s << u"+"_s << u"2"_s << u"2.5"_s;
+    QTest::addRow("int - double") << u"2"_s << u"-"_s << u"0.5"_s << u"1.5"_s;
+    QTest::addRow("double - double") << u"0.5"_s << u"-"_s << u"2.5"_s << u"-2"_s;
+    QTest::addRow("double * double") << u"1.5"_s << u"*"_s << u"1.5"_s << u"2.25"_s;
+    QTest::addRow("infinity") << u"1e308"_s << u"*"_s << u"10"_s << u"Infinity"_s;
+    QTest::addRow("NaN result") << u"Infinity"_s << u"-"_s << u"Infinity"_s << u"NaN"_s;
+    QTest::addRow("NaN operand") << u"NaN"_s << u"+"_s << u"1.5"_s << u"NaN"_s;
+    QTest::addRow("string") << u"'a'"_s << u"+"_s << u"1.5"_s << u"a1.5"_s;
+    QTest::addRow("undefined") << u"undefined"_s << u"*"_s << u"1.5"_s << u"NaN"_s;
+}
+
+void tst_QV4Assembler::numberArithmetic()
+{
+    QFETCH(QString, lhs);
+    QFETCH(QString, op);
+    QFETCH(QString, rhs);
+    QFETCH(QString, expected);
+
+    QJSEngine engine;
+    QJSValue function = engine.evaluate(u"(function(a, b) { return a %1 b; })"_s.arg(op));
+    QVERIFY(function.isCallable());
+    const QJSValueList arguments = { engine.evaluate(lhs), engine.evaluate(rhs) };
+
+    // call it repeatedly, so that it runs both interpreted and jitted
+    for (int i = 0; i < 5; ++i)
+        QCOMPARE(function.call(arguments).toString(), expected);
+}
+
+void tst_QV4Assembler::onStackReplacement_data()
+{
+    QTest::addColumn<QString>("function");
+    QTest::addColumn<QString>("expected");
+    QTest::addColumn<bool>("jitted");
+
+    QTest::addRow("for") << u"function(n) { var s = 0; for (var i = 0; i < n; ++i) s += i; return s; }"_s
+                         << u"49995000"_s << true;
+    QTest::addRow("while") << u"function(n) { var s = 0.5; while (n--) s += 1; return s; }"_s
+                           << u"10000.5"_s << true;
+    QTest::addRow("do while") << u"function(n) { var s = ''; do { s = n; } while (--n); return s; }"_s
+                              << u"1"_s << true;
+    QTest::addRow("nested") << u"function(n) { var s = 0; for (var i = 0; i < 100; ++i) "
+                               u"for (var j = 0; j < n / 100; ++j) s += j; return s; }"_s
+                            << u"495000"_s << true;
+    QTest::addRow("closure") << u"function(n) { var s = 0; var add = function(x) { s += x; }; "
+                                u"for (let i = 0; i < n; ++i) add(i); return s; }"_s
+                             << u"49995000"_s << true;
+    QTest::addRow("try") << u"function(n) { var s = 0; try { for (var i = 0; i < n; ++i) s += i; "
+                            u"throw s; } catch (e) { return e + 1; } }"_s
+                         << u"49995001"_s << false;
+}
+
+void tst_QV4Assembler::onStackReplacement()
+{
+    QFETCH(QString, function);
+    QFETCH(QString, expected);
+    QFETCH(bool, jitted);
+
+    // only the loop can make the function hot, not the number of calls
+    qputenv("QV4_JIT_CALL_THRESHOLD", "1");
+    QJSEngine engine;
+    qputenv("QV4_JIT_CALL_THRESHOLD", "0");
+
+    QJSValue callable = engine.evaluate(u"(%1)"_s.arg(function));
+    QVERIFY(callable.isCallable());
+    QCOMPARE(callable.call({ 10000 }).toString(), expected);
+
+    auto *functionObject
+            = QJSValuePrivate::asManagedType<QV4::JavaScriptFunctionObject>(&callable);
+    QVERIFY(functionObject);
+#if QT_CONFIG(qml_jit)
+    QCOMPARE(functionObject->d()->function->jittedCode != nullptr, jitted);
+#else
+    Q_UNUSED(jitted);
+#endif
+
+    // and once more, from the start
+    QCOMPARE(callable.call({ 10000 }).toString(), expected);
+}
+
 QTEST_MAIN(tst_QV4Assembler)
 
 #include "tst_qv4assembler.moc"
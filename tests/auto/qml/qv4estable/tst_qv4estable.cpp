@@ -10,6 +10,8 @@ class tst_qv4estable : public QObject
 
 private slots:
     void checkRemoveAvoidsHeapBufferOverflow();
+    void removeKeepsInsertionOrder();
+    void iteratorSurvivesCompaction();
 };
 
 // QTBUG-123999
@@ -35,6 +37,80 @@ void tst_qv4estable::checkRemoveAvoidsHeapBufferOverflow()
     estable.remove(QV4::Value::fromUInt32(0));
 }
 
+void tst_qv4estable::removeKeepsInsertionOrder()
+{
+    QV4::ESTable estable;
+
+    for (uint i = 0; i < 100; ++i)
+        estable.set(QV4::Value::fromUInt32(i), QV4::Value::fromUInt32(i * 2));
+    for (uint i = 0; i < 100; i += 2)
+        QVERIFY(estable.remove(QV4::Value::fromUInt32(i)));
+    QVERIFY(!estable.remove(QV4::Value::fromUInt32(0)));
+    QCOMPARE_EQ(estable.size(), 50U);
+
+    // Numbers are looked up by value, independent of their encoding.
+    QVERIFY(estable.has(QV4::Value::fromDouble(3)));
+    QVERIFY(!estable.has(QV4::Value::fromDouble(4)));
+    QCOMPARE_EQ(estable.get(QV4::Value::fromDouble(99)), QV4::Value::fromUInt32(198).asReturnedValue());
+
+    // Fill up the holes again, which makes the table compact itself.
+    for (uint i = 100; i < 150; ++i)
+        estable.set(QV4::Value::fromUInt32(i), QV4::Value::fromUInt32(i * 2));
+    QCOMPARE_EQ(estable.size(), 100U);
+
+    uint index = 0;
+    uint expected = 1;
+    QV4::Value key;
+    QV4::Value value;
+    while (estable.iterate(&index, &key, &value)) {
+        QVERIFY(key.sameValueZero(QV4::Value::fromUInt32(expected)));
+        QVERIFY(value.sameValueZero(QV4::Value::fromUInt32(expected * 2)));
+        expected = expected < 99 ? expected + 2 : (expected == 99 ? 100 : expected + 1);
+        ++index;
+    }
+    QCOMPARE_EQ(expected, 150U);
+}
+
+void tst_qv4estable::iteratorSurvivesCompaction()
+{
+    QV4::ESTable estable;
+
+    for (uint i = 1; i <= 8; ++i)
+        estable.set(QV4::Value::fromUInt32(i), QV4::Value::fromUInt32(i));
+
+    uint index = 0;
+    quint64 sequenceNumber = 0;
+    QV4::Value key;
+    QV4::Value value;
+    for (uint i = 1; i <= 3; ++i) {
+        QVERIFY(estable.iterate(&index, &sequenceNumber, &key, &value));
+        QVERIFY(key.sameValueZero(QV4::Value::fromUInt32(i)));
+        ++index;
+        ++sequenceNumber;
+    }
+
+    // Removing entries in front of the iterator and adding one to the full
+    // table moves the remaining entries to the left.
+    QVERIFY(estable.remove(QV4::Value::fromUInt32(1)));
+    QVERIFY(estable.remove(QV4::Value::fromUInt32(2)));
+    estable.set(QV4::Value::fromUInt32(9), QV4::Value::fromUInt32(9));
+    QCOMPARE_EQ(estable.m_deleted, 0U);
+
+    for (uint i = 4; i <= 9; ++i) {
+        QVERIFY(estable.iterate(&index, &sequenceNumber, &key, &value));
+        QVERIFY(key.sameValueZero(QV4::Value::fromUInt32(i)));
+        ++index;
+        ++sequenceNumber;
+    }
+    QVERIFY(!estable.iterate(&index, &sequenceNumber, &key, &value));
+
+    // Entries added after clear() are visited as well.
+    estable.clear();
+    estable.set(QV4::Value::fromUInt32(10), QV4::Value::fromUInt32(10));
+    QVERIFY(estable.iterate(&index, &sequenceNumber, &key, &value));
+    QVERIFY(key.sameValueZero(QV4::Value::fromUInt32(10)));
+}
+
 QTEST_MAIN(tst_qv4estable)
 
 #include "tst_qv4estable.moc"
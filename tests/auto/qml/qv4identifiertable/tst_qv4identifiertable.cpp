@@ -20,6 +20,7 @@ private slots:
     void sweepAcrossBucketBoundariesIfFirstBucketFull();
     void sweepBucketGap();
     void insertNumericStringPopulatesIdentifier();
+    void insertLatin1String();
 };
 
 void tst_qv4identifiertable::sweepFirstEntryInBucket()
@@ -347,6 +348,25 @@ void tst_qv4identifiertable::insertNumericStringPopulatesIdentifier()
              QV4::PropertyKey::fromArrayIndex(hash));
 }
 
+void tst_qv4identifiertable::insertLatin1String()
+{
+    QV4::ExecutionEngine engine;
+
+    // Finds the identifier that was inserted as QString
+    QV4::Heap::String *length = engine.identifierTable->insertString(QStringLiteral("length"));
+    QCOMPARE(engine.identifierTable->insertString(QLatin1StringView("length")), length);
+
+    // Hashes non-ASCII Latin-1 characters the same way
+    const QString nonAscii = QString::fromLatin1("gr\xfc\xdf" "e");
+    QV4::Heap::String *inserted = engine.identifierTable->insertString(
+            QLatin1StringView("gr\xfc\xdf" "e"));
+    QCOMPARE(inserted->toQString(), nonAscii);
+    QCOMPARE(engine.identifierTable->insertString(nonAscii), inserted);
+
+    QCOMPARE(engine.identifierTable->insertString(QLatin1StringView("1"))->identifier,
+             QV4::PropertyKey::fromArrayIndex(1));
+}
+
 QTEST_MAIN(tst_qv4identifiertable)
 
 #include "tst_qv4identifiertable.moc"
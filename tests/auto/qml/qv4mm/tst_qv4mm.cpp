@@ -47,6 +47,9 @@ private slots:
     void forInOnProxyMarksTarget();
     void allocWithMemberDataMidwayDrain();
     void markObjectWrappersAfterMarkWeakValues();
+    void allocateWhileSweeping();
+    void runGCInIdleTime();
+    void fragmentedMemory();
 };
 
 tst_qv4mm::tst_qv4mm()
@@ -835,6 +838,120 @@ void tst_qv4mm::markObjectWrappersAfterMarkWeakValues()
     QCOMPARE(qvariant_cast<QObject *>(retrieved)->objectName(), "yep");
 }
 
+void tst_qv4mm::allocateWhileSweeping()
+{
+    QV4::ExecutionEngine v4;
+    QV4::MemoryManager *mm = v4.memoryManager;
+    QCOMPARE(mm->gcBlocked, QV4::MemoryManager::Unblocked);
+
+    QV4::Scope scope(&v4);
+    QV4::ScopedArrayObject survivors(scope, v4.newArrayObject());
+    const auto addObject = [&](int i, bool keep) {
+        QV4::Scope inner(&v4);
+        QV4::ScopedObject object(inner, v4.newObject());
+        QV4::ScopedString key(inner, v4.newString(QStringLiteral("key%1").arg(i)));
+        QV4::ScopedValue value(inner, QV4::Value::fromInt32(i));
+        object->put(key, value);
+        if (keep)
+            survivors->push_back(object);
+    };
+
+    // create garbage spanning many chunks, without letting the gc run in between
+    mm->gcBlocked = QV4::MemoryManager::NormalBlocked;
+    for (int i = 0; i < 50000; ++i)
+        addObject(i % 1000, false);
+
+    auto sm = mm->gcStateMachine.get();
+    sm->reset();
+    sm->deadline = QDeadlineTimer(QDeadlineTimer::Forever);
+    while (sm->state != QV4::GCState::SweepBlockAllocator) {
+        QV4::GCStateInfo& stateInfo = sm->stateInfoMap[int(sm->state)];
+        sm->state = stateInfo.execute(sm, sm->stateData);
+    }
+
+    // with an expired deadline, each step sweeps a single chunk
+    sm->deadline = QDeadlineTimer();
+    int steps = 0;
+    while (sm->state == QV4::GCState::SweepBlockAllocator) {
+        // the mutator allocates between two steps, and adds the same properties the
+        // garbage had; it must not pick up the internal classes of the garbage
+        addObject(steps % 1000, true);
+        QV4::GCStateInfo& stateInfo = sm->stateInfoMap[int(sm->state)];
+        sm->state = stateInfo.execute(sm, sm->stateData);
+        ++steps;
+    }
+    QVERIFY(steps > 1);
+    QCOMPARE(sm->state, QV4::GCState::FinishSweep);
+    QVERIFY(mm->tryForceGCCompletion());
+    QCOMPARE(mm->gcBlocked, QV4::MemoryManager::Unblocked);
+
+    mm->runFullGC();
+    QCOMPARE(survivors->getLength(), steps);
+    QV4::ScopedObject object(scope);
+    QV4::ScopedString key(scope);
+    for (int i = 0; i < steps; ++i) {
+        object = survivors->get(i);
+        QVERIFY(object);
+        key = v4.newString(QStringLiteral("key%1").arg(i % 1000));
+        QCOMPARE(QV4::Value::fromReturnedValue(object->get(key)).toInt32(), i % 1000);
+    }
+}
+
+void tst_qv4mm::runGCInIdleTime()
+{
+    QJSEngine engine;
+    QV4::ExecutionEngine &v4 = *engine.handle();
+    QV4::MemoryManager *mm = v4.memoryManager;
+    auto sm = mm->gcStateMachine.get();
+    QVERIFY(!sm->inProgress());
+
+    mm->gcBlocked = QV4::MemoryManager::NormalBlocked;
+    sm->reset();
+
+    // while steps are deferred, the event loop doesn't advance the cycle
+    mm->runGCInIdleTime(QDeadlineTimer(), QDeadlineTimer(std::chrono::hours(1)));
+    QCOMPARE(sm->state, QV4::GCState::MarkStart);
+    mm->onEventLoop();
+    QCoreApplication::processEvents();
+    QCOMPARE(sm->state, QV4::GCState::MarkStart);
+    QVERIFY(mm->deferredGCStepScheduled);
+
+    // idle time does
+    mm->runGCInIdleTime(QDeadlineTimer(QDeadlineTimer::Forever), QDeadlineTimer());
+    QVERIFY(!sm->inProgress());
+    QCOMPARE(mm->gcBlocked, QV4::MemoryManager::Unblocked);
+}
+
+void tst_qv4mm::fragmentedMemory()
+{
+    QV4::ExecutionEngine v4;
+    QV4::MemoryManager *mm = v4.memoryManager;
+
+    QV4::Scope scope(&v4);
+    QV4::ScopedArrayObject survivors(scope, v4.newArrayObject());
+    QV4::ScopedObject object(scope);
+
+    // keep a few objects in every chunk alive, so that none of them becomes empty
+    mm->gcBlocked = QV4::MemoryManager::NormalBlocked;
+    for (int i = 0; i < 50000; ++i) {
+        object = v4.newObject();
+        if (i % 50 == 0)
+            survivors->push_back(object);
+    }
+    object = QV4::Value::undefinedValue();
+    mm->gcBlocked = QV4::MemoryManager::Unblocked;
+
+    mm->runFullGC();
+    const size_t fragmented = mm->getFragmentedMem();
+    QVERIFY(fragmented > 10 * QV4::Chunk::DataSize);
+
+    // once the survivors are gone, the chunks are empty and returned
+    survivors = v4.newArrayObject();
+    mm->runFullGC();
+    QVERIFY2(mm->getFragmentedMem() < fragmented / 2,
+             qPrintable(QStringLiteral("%1 -> %2").arg(fragmented).arg(mm->getFragmentedMem())));
+}
+
 QTEST_MAIN(tst_qv4mm)
 
 #include "tst_qv4mm.moc"
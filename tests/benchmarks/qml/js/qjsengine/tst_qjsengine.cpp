@@ -182,6 +182,44 @@ void tst_QJSEngine::evaluate_data()
     QTest::newRow("while loop (100000 iterations)") << QString::fromLatin1("i = 0; while (i < 100000) { ++i; }; i");
     QTest::newRow("while loop (1000000 iterations)") << QString::fromLatin1("i = 0; while (i < 1000000) { ++i; }; i");
     QTest::newRow("function expression") << QString::fromLatin1("(function(a, b, c){ return a + b + c; })(1, 2, 3)");
+    QTest::newRow("floating point arithmetic (100 calls, 1000 iterations)") << QString::fromLatin1(
+            "function step(x, v, dt) { for (var i = 0; i < 1000; ++i) { v = v - x * 0.5 * dt; x = x + v * dt; } return x; }"
+            "var x = 1.5; for (var n = 0; n < 100; ++n) x = step(x, 0.25, 0.01); x");
+    QTest::newRow("filling an array by index (100000 elements)") << QString::fromLatin1(
+            "(function() { var a = []; for (var i = 0; i < 100000; ++i) a[i] = i * 0.5; return a.length; })()");
+    QTest::newRow("JSON round trip of records (10000 elements)") << QString::fromLatin1(
+            "(function() { var a = []; for (var i = 0; i < 10000; ++i) a.push({ id: i, name: 'item ' + i, tags: ['x', 'y'], price: i * 0.25 });"
+            "return JSON.parse(JSON.stringify(a)).length; })()");
+    QTest::newRow("formatting log lines (10000 lines)") << QString::fromLatin1(
+            "(function() { var log = ''; for (var i = 0; i < 10000; ++i) {"
+            "log += '[' + (i % 3 ? 'info' : 'warn') + '] ' + i + ': request took ' + (i * 0.5) + ' ms\\n';"
+            "if (log.endsWith('!')) break; } return log.length; })()");
+    QTest::newRow("building CSV (2000 rows, 8 columns)") << QString::fromLatin1(
+            "(function() { var csv = ''; for (var r = 0; r < 2000; ++r) { var row = '';"
+            "for (var c = 0; c < 8; ++c) row += (c ? ',' : '') + (r * c);"
+            "csv += row + '\\n'; } return csv.length; })()");
+    QTest::newRow("constructing objects (100000 instances)") << QString::fromLatin1(
+            "(function() { function Item(i) { this.id = i; this.name = 'item'; this.x = i; this.y = -i; this.z = 0; this.visible = true; }"
+            "var sum = 0; for (var i = 0; i < 100000; ++i) sum += new Item(i).x; return sum; })()");
+    QTest::newRow("Map insert (20000 keys)") << QString::fromLatin1(
+            "(function() { var m = new Map(); for (var i = 0; i < 20000; ++i) m.set('key' + i, i); return m.size; })()");
+    QTest::newRow("Map lookup (20000 keys)") << QString::fromLatin1(
+            "(function() { var m = new Map(); for (var i = 0; i < 20000; ++i) m.set(i, i);"
+            "var sum = 0; for (var j = 0; j < 5; ++j) for (var i = 0; i < 20000; ++i) sum += m.get(i); return sum; })()");
+    QTest::newRow("Set insert and delete (20000 keys)") << QString::fromLatin1(
+            "(function() { var s = new Set(); var keys = []; for (var i = 0; i < 20000; ++i) keys.push({ id: i });"
+            "for (var i = 0; i < 20000; ++i) s.add(keys[i]); for (var i = 0; i < 20000; i += 2) s.delete(keys[i]);"
+            "for (var i = 0; i < 20000; i += 2) s.add(keys[i]); return s.size; })()");
+    QTest::newRow("Map iteration (20000 keys)") << QString::fromLatin1(
+            "(function() { var m = new Map(); for (var i = 0; i < 20000; ++i) m.set(i, i);"
+            "var sum = 0; for (var [k, v] of m) sum += v; m.forEach(function(v) { sum += v; }); return sum; })()");
+    QTest::newRow("Float32Array indexed access (1000000 elements)") << QString::fromLatin1(
+            "(function() { var a = new Float32Array(1000000); for (var i = 0; i < a.length; ++i) a[i] = i * 0.5;"
+            "var sum = 0; for (var i = 0; i < a.length; ++i) sum += a[i]; return sum; })()");
+    QTest::newRow("Int16Array fill, indexOf and sort (1000000 elements)") << QString::fromLatin1(
+            "(function() { var a = new Int16Array(1000000); a.fill(7); a[999999] = 3;"
+            "var r = a.indexOf(3) + a.lastIndexOf(7) + a.includes(3);"
+            "for (var i = 0; i < a.length; i += 3) a[i] = (i * 7919) & 0x7fff; a.sort(); return r + a[0]; })()");
 }
 
 void tst_QJSEngine::evaluate()
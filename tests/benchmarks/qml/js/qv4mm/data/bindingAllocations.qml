@@ -0,0 +1,25 @@
+import QtQml
+
+QtObject {
+    id: root
+
+    // Number of long-lived objects kept alive for the lifetime of the component.
+    // They model the QML object graph that every gc cycle has to re-mark.
+    property int retained: 0
+    property var longLived: {
+        const result = [];
+        for (let i = 0; i < retained; ++i)
+            result.push({ index: i, name: "item" + i, children: [i, i + 1] });
+        return result;
+    }
+
+    // Each re-evaluation creates a few hundred short-lived temporaries.
+    property int input: 0
+    property var points: {
+        const result = [];
+        for (let i = 0; i < 100; ++i)
+            result.push({ x: i, y: i * root.input, label: "p" + i });
+        return result;
+    }
+    property string summary: points.map(p => p.label + ":" + p.y).join(",")
+}
@@ -0,0 +1,144 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <qtest.h>
+#include <QtQml/qqmlengine.h>
+#include <QtQml/qqmlcomponent.h>
+#include <QtCore/qelapsedtimer.h>
+
+#include <private/qv4engine_p.h>
+#include <private/qv4mm_p.h>
+
+#include <memory>
+
+class tst_qv4mm : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void bindingThroughput_data();
+    void bindingThroughput();
+    void fullCollection_data();
+    void fullCollection();
+    void markPhase_data();
+    void markPhase();
+
+private:
+    void addRetainedColumn();
+    std::unique_ptr<QObject> createObject(QQmlEngine *engine, int retained);
+};
+
+static QUrl testFileUrl(const char *fileName)
+{
+    return QUrl::fromLocalFile(QLatin1String(SRCDIR "/data/") + QLatin1String(fileName));
+}
+
+void tst_qv4mm::addRetainedColumn()
+{
+    QTest::addColumn<int>("retained");
+
+    QTest::addRow("no long-lived objects") << 0;
+    QTest::addRow("10k long-lived objects") << 10000;
+    QTest::addRow("100k long-lived objects") << 100000;
+}
+
+std::unique_ptr<QObject> tst_qv4mm::createObject(QQmlEngine *engine, int retained)
+{
+    QQmlComponent component(engine, testFileUrl("bindingAllocations.qml"));
+    std::unique_ptr<QObject> object(component.createWithInitialProperties(
+            { { QStringLiteral("retained"), retained } }));
+    if (!object)
+        qWarning() << component.errorString();
+    return object;
+}
+
+void tst_qv4mm::bindingThroughput_data()
+{
+    addRetainedColumn();
+}
+
+/*
+    Re-evaluates bindings that produce a lot of short-lived garbage while a
+    (potentially large) long-lived object graph is kept alive. The gc cost of
+    every cycle is dominated by re-marking the long-lived graph.
+ */
+void tst_qv4mm::bindingThroughput()
+{
+    QFETCH(int, retained);
+
+    QQmlEngine engine;
+    std::unique_ptr<QObject> object = createObject(&engine, retained);
+    QVERIFY(object);
+
+    int input = 0;
+    QBENCHMARK {
+        object->setProperty("input", ++input);
+        QVERIFY(!object->property("summary").toString().isEmpty());
+    }
+}
+
+void tst_qv4mm::fullCollection_data()
+{
+    addRetainedColumn();
+}
+
+/*
+    Measures the pause of a non-incremental collection, depending on the
+    size of the long-lived object graph.
+ */
+void tst_qv4mm::fullCollection()
+{
+    QFETCH(int, retained);
+
+    QQmlEngine engine;
+    std::unique_ptr<QObject> object = createObject(&engine, retained);
+    QVERIFY(object);
+
+    QV4::MemoryManager *mm = engine.handle()->memoryManager;
+    QBENCHMARK {
+        object->setProperty("input", object->property("input").toInt() + 1);
+        mm->runFullGC();
+    }
+}
+
+void tst_qv4mm::markPhase_data()
+{
+    addRetainedColumn();
+}
+
+/*
+    Measures only the mark phases (everything up to MarkReady) of a single,
+    non-interrupted gc cycle. This is the part of the collection that scales
+    with the size of the live heap.
+ */
+void tst_qv4mm::markPhase()
+{
+    QFETCH(int, retained);
+
+    QQmlEngine engine;
+    std::unique_ptr<QObject> object = createObject(&engine, retained);
+    QVERIFY(object);
+
+    QV4::MemoryManager *mm = engine.handle()->memoryManager;
+    mm->runFullGC();
+    QVERIFY(!mm->gcStateMachine->inProgress());
+
+    auto sm = mm->gcStateMachine.get();
+    sm->reset();
+    sm->deadline = QDeadlineTimer(QDeadlineTimer::Forever);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (sm->state != QV4::GCState::MarkReady) {
+        QV4::GCStateInfo &stateInfo = sm->stateInfoMap[int(sm->state)];
+        sm->state = stateInfo.execute(sm, sm->stateData);
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    QVERIFY(mm->tryForceGCCompletion());
+    QTest::setBenchmarkResult(elapsed, QTest::WalltimeNanoseconds);
+}
+
+QTEST_MAIN(tst_qv4mm)
+
+#include "tst_qv4mm.moc"